@@ -8,6 +8,8 @@
 #include "exti_driver.h"
 #include "systick_driver.h"
 #include "timer_driver.h"
+#include "soft_timer_driver.h"
+#include "dma_driver.h"
 
 /**
  * @section System Exception Handlers.
@@ -20,7 +22,8 @@
  */
 void SysTick_Handler(void)
 {
-    tick++;
+    sysTickHandleIrq();
+    softTimerHandleTick();
 }
 
 /**
@@ -106,6 +109,49 @@ void EXTI15_10_IRQHandler(void)
     extiHandleIrq(15U);
 }
 
+/**
+ * @brief  Handles Timer 1 break and Timer 9 global interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM1_BRK_TIM9_IRQHandler(void)
+{
+    timerHandleIrqFlags(TIM1, TIM_SR_BIF);
+    timerHandleIrq(TIM9);
+}
+
+/**
+ * @brief  Handles Timer 1 update and Timer 10 global interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM1_UP_TIM10_IRQHandler(void)
+{
+    timerHandleIrqFlags(TIM1, TIM_SR_UIF);
+    timerHandleIrq(TIM10);
+}
+
+/**
+ * @brief  Handles Timer 1 trigger/commutation and Timer 11 global interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM1_TRG_COM_TIM11_IRQHandler(void)
+{
+    timerHandleIrqFlags(TIM1, TIM_SR_TIF | TIM_SR_COMIF);
+    timerHandleIrq(TIM11);
+}
+
+/**
+ * @brief  Handles Timer 1 capture compare interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM1_CC_IRQHandler(void)
+{
+    timerHandleIrqFlags(TIM1, TIM_SR_CC1IF | TIM_SR_CC2IF | TIM_SR_CC3IF | TIM_SR_CC4IF);
+}
+
 /**
  * @brief  Handles Timer 2 interrupt.
  * @param  None
@@ -114,4 +160,268 @@ void EXTI15_10_IRQHandler(void)
 void TIM2_IRQHandler(void)
 {
     timerHandleIrq(TIM2);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief  Handles Timer 3 interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM3_IRQHandler(void)
+{
+    timerHandleIrq(TIM3);
+}
+
+/**
+ * @brief  Handles Timer 4 interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM4_IRQHandler(void)
+{
+    timerHandleIrq(TIM4);
+}
+
+/**
+ * @brief  Handles Timer 8 break and Timer 12 global interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM8_BRK_TIM12_IRQHandler(void)
+{
+    timerHandleIrqFlags(TIM8, TIM_SR_BIF);
+    timerHandleIrq(TIM12);
+}
+
+/**
+ * @brief  Handles Timer 8 update and Timer 13 global interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM8_UP_TIM13_IRQHandler(void)
+{
+    timerHandleIrqFlags(TIM8, TIM_SR_UIF);
+    timerHandleIrq(TIM13);
+}
+
+/**
+ * @brief  Handles Timer 8 trigger/commutation and Timer 14 global interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM8_TRG_COM_TIM14_IRQHandler(void)
+{
+    timerHandleIrqFlags(TIM8, TIM_SR_TIF | TIM_SR_COMIF);
+    timerHandleIrq(TIM14);
+}
+
+/**
+ * @brief  Handles Timer 8 capture compare interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM8_CC_IRQHandler(void)
+{
+    timerHandleIrqFlags(TIM8, TIM_SR_CC1IF | TIM_SR_CC2IF | TIM_SR_CC3IF | TIM_SR_CC4IF);
+}
+
+/**
+ * @brief  Handles Timer 5 interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM5_IRQHandler(void)
+{
+    timerHandleIrq(TIM5);
+}
+
+/**
+ * @brief  Handles Timer 6 and DAC underrun interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM6_DAC_IRQHandler(void)
+{
+    timerHandleIrq(TIM6);
+}
+
+/**
+ * @brief  Handles Timer 7 interrupt.
+ * @param  None
+ * @return None
+ */
+void TIM7_IRQHandler(void)
+{
+    timerHandleIrq(TIM7);
+}
+
+/**
+ * @brief  Handles DMA1 Stream 0 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA1_Stream0_IRQHandler(void)
+{
+    dmaHandleIrq(DMA1_Stream0);
+}
+
+/**
+ * @brief  Handles DMA1 Stream 1 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA1_Stream1_IRQHandler(void)
+{
+    dmaHandleIrq(DMA1_Stream1);
+}
+
+/**
+ * @brief  Handles DMA1 Stream 2 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA1_Stream2_IRQHandler(void)
+{
+    dmaHandleIrq(DMA1_Stream2);
+}
+
+/**
+ * @brief  Handles DMA1 Stream 3 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA1_Stream3_IRQHandler(void)
+{
+    dmaHandleIrq(DMA1_Stream3);
+}
+
+/**
+ * @brief  Handles DMA1 Stream 4 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA1_Stream4_IRQHandler(void)
+{
+    dmaHandleIrq(DMA1_Stream4);
+}
+
+/**
+ * @brief  Handles DMA1 Stream 5 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA1_Stream5_IRQHandler(void)
+{
+    dmaHandleIrq(DMA1_Stream5);
+}
+
+/**
+ * @brief  Handles DMA1 Stream 6 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA1_Stream6_IRQHandler(void)
+{
+    dmaHandleIrq(DMA1_Stream6);
+}
+
+/**
+ * @brief  Handles DMA1 Stream 7 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA1_Stream7_IRQHandler(void)
+{
+    dmaHandleIrq(DMA1_Stream7);
+}
+
+/**
+ * @brief  Handles DMA2 Stream 0 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA2_Stream0_IRQHandler(void)
+{
+    dmaHandleIrq(DMA2_Stream0);
+}
+
+/**
+ * @brief  Handles DMA2 Stream 1 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA2_Stream1_IRQHandler(void)
+{
+    dmaHandleIrq(DMA2_Stream1);
+}
+
+/**
+ * @brief  Handles DMA2 Stream 2 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA2_Stream2_IRQHandler(void)
+{
+    dmaHandleIrq(DMA2_Stream2);
+}
+
+/**
+ * @brief  Handles DMA2 Stream 3 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA2_Stream3_IRQHandler(void)
+{
+    dmaHandleIrq(DMA2_Stream3);
+}
+
+/**
+ * @brief  Handles DMA2 Stream 4 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA2_Stream4_IRQHandler(void)
+{
+    dmaHandleIrq(DMA2_Stream4);
+}
+
+/**
+ * @brief  Handles DMA2 Stream 5 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA2_Stream5_IRQHandler(void)
+{
+    dmaHandleIrq(DMA2_Stream5);
+}
+
+/**
+ * @brief  Handles DMA2 Stream 6 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA2_Stream6_IRQHandler(void)
+{
+    dmaHandleIrq(DMA2_Stream6);
+}
+
+/**
+ * @brief  Handles DMA2 Stream 7 interrupt.
+ * @param  None
+ * @return None
+ */
+void DMA2_Stream7_IRQHandler(void)
+{
+    dmaHandleIrq(DMA2_Stream7);
+}
+
+/**
+ * @brief  Handles vector 80, reserved on the STM32F446 and used as the
+ *         software timer interrupt (SOFT_TIMER_IRQn).
+ * @param  None
+ * @return None
+ */
+void HASH_RNG_IRQHandler(void)
+{
+    softTimerHandleIrq();
+}
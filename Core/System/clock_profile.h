@@ -0,0 +1,150 @@
+/**
+ * @file    clock_profile.h
+ * @author  Pratik Dhulubulu
+ * @brief   Compile-time board clock profile.
+ * @details The board is selected with the BOARD Makefile variable, which
+ *          defines BOARD_<name>. Each profile only states the oscillator and
+ *          divider settings; the whole clock tree is derived here as integer
+ *          constant expressions so they can be used in #if and to fold baud
+ *          rate and prescaler values at compile time.
+ */
+
+#ifndef CLOCK_PROFILE_H
+#define CLOCK_PROFILE_H
+
+/**
+ * @section Clock Source Selection.
+ * @note    Values match RCC_CLK_SRC in rcc_driver.h.
+ */
+#define CLK_SRC_HSI     0
+#define CLK_SRC_HSE     1
+#define CLK_SRC_PLL     2
+
+#define CLK_HSI_HZ      16000000UL
+
+/**
+ * @section Board Profiles.
+ */
+#if defined(BOARD_NUCLEO_F446RE)
+/* 8 MHz from ST-LINK MCO, HSE in bypass mode */
+#define CLK_HSE_HZ          8000000UL
+#define CLK_HSE_BYPASS      1
+#define CLK_SYSCLK_SRC      CLK_SRC_PLL
+#define CLK_PLL_SRC         CLK_SRC_HSE
+#define CLK_PLL_M           4UL
+#define CLK_PLL_N           168UL
+#define CLK_PLL_P           2UL
+#define CLK_PLL_Q           7UL
+#define CLK_AHB_DIV         1UL
+#define CLK_APB1_DIV        4UL
+#define CLK_APB2_DIV        2UL
+
+#elif defined(BOARD_HSE_12MHZ)
+/* 12 MHz crystal */
+#define CLK_HSE_HZ          12000000UL
+#define CLK_HSE_BYPASS      0
+#define CLK_SYSCLK_SRC      CLK_SRC_PLL
+#define CLK_PLL_SRC         CLK_SRC_HSE
+#define CLK_PLL_M           6UL
+#define CLK_PLL_N           168UL
+#define CLK_PLL_P           2UL
+#define CLK_PLL_Q           7UL
+#define CLK_AHB_DIV         1UL
+#define CLK_APB1_DIV        4UL
+#define CLK_APB2_DIV        2UL
+
+#elif defined(BOARD_HSE_25MHZ)
+/* 25 MHz crystal */
+#define CLK_HSE_HZ          25000000UL
+#define CLK_HSE_BYPASS      0
+#define CLK_SYSCLK_SRC      CLK_SRC_PLL
+#define CLK_PLL_SRC         CLK_SRC_HSE
+#define CLK_PLL_M           25UL
+#define CLK_PLL_N           336UL
+#define CLK_PLL_P           2UL
+#define CLK_PLL_Q           7UL
+#define CLK_AHB_DIV         1UL
+#define CLK_APB1_DIV        4UL
+#define CLK_APB2_DIV        2UL
+
+#elif defined(BOARD_HSI_ONLY)
+/* No crystal fitted, PLL runs from HSI */
+#define CLK_HSE_HZ          0UL
+#define CLK_HSE_BYPASS      0
+#define CLK_SYSCLK_SRC      CLK_SRC_PLL
+#define CLK_PLL_SRC         CLK_SRC_HSI
+#define CLK_PLL_M           8UL
+#define CLK_PLL_N           168UL
+#define CLK_PLL_P           2UL
+#define CLK_PLL_Q           7UL
+#define CLK_AHB_DIV         1UL
+#define CLK_APB1_DIV        4UL
+#define CLK_APB2_DIV        2UL
+
+#else
+#error "No board clock profile selected, set BOARD in the Makefile."
+#endif
+
+/**
+ * @section Derived Clock Tree.
+ */
+#define CLK_PLL_IN_HZ       ((CLK_PLL_SRC == CLK_SRC_HSE) ? CLK_HSE_HZ : CLK_HSI_HZ)
+#define CLK_PLL_VCO_IN_HZ   (CLK_PLL_IN_HZ / CLK_PLL_M)
+#define CLK_PLL_VCO_HZ      (CLK_PLL_VCO_IN_HZ * CLK_PLL_N)
+#define CLK_PLL_P_HZ        (CLK_PLL_VCO_HZ / CLK_PLL_P)
+#define CLK_PLL_Q_HZ        (CLK_PLL_VCO_HZ / CLK_PLL_Q)
+
+#define CLK_SYSCLK_HZ       ((CLK_SYSCLK_SRC == CLK_SRC_PLL) ? CLK_PLL_P_HZ : \
+                             (CLK_SYSCLK_SRC == CLK_SRC_HSE) ? CLK_HSE_HZ : CLK_HSI_HZ)
+#define CLK_HCLK_HZ         (CLK_SYSCLK_HZ / CLK_AHB_DIV)
+#define CLK_PCLK1_HZ        (CLK_HCLK_HZ / CLK_APB1_DIV)
+#define CLK_PCLK2_HZ        (CLK_HCLK_HZ / CLK_APB2_DIV)
+
+/* Timer kernel clock is PCLKx when APBx is undivided, otherwise 2 x PCLKx */
+#define CLK_TIMCLK1_HZ      ((CLK_APB1_DIV == 1UL) ? CLK_PCLK1_HZ : (2UL * CLK_PCLK1_HZ))
+#define CLK_TIMCLK2_HZ      ((CLK_APB2_DIV == 1UL) ? CLK_PCLK2_HZ : (2UL * CLK_PCLK2_HZ))
+
+/* Flash wait states for 2.7 V - 3.6 V supply, one per 30 MHz of HCLK */
+#define CLK_FLASH_LATENCY   ((CLK_HCLK_HZ - 1UL) / 30000000UL)
+
+/**
+ * @section Register Field Encodings.
+ */
+#define CLK_HPRE_BITS       ((CLK_AHB_DIV == 1UL)   ? 0x0UL : (CLK_AHB_DIV == 2UL)   ? 0x8UL : \
+                             (CLK_AHB_DIV == 4UL)   ? 0x9UL : (CLK_AHB_DIV == 8UL)   ? 0xAUL : \
+                             (CLK_AHB_DIV == 16UL)  ? 0xBUL : (CLK_AHB_DIV == 64UL)  ? 0xCUL : \
+                             (CLK_AHB_DIV == 128UL) ? 0xDUL : (CLK_AHB_DIV == 256UL) ? 0xEUL : 0xFUL)
+#define CLK_PPRE_BITS(div)  (((div) == 1UL) ? 0x0UL : ((div) == 2UL) ? 0x4UL : \
+                             ((div) == 4UL) ? 0x5UL : ((div) == 8UL) ? 0x6UL : 0x7UL)
+#define CLK_PPRE1_BITS      CLK_PPRE_BITS(CLK_APB1_DIV)
+#define CLK_PPRE2_BITS      CLK_PPRE_BITS(CLK_APB2_DIV)
+
+/**
+ * @brief Single source of truth for the CMSIS system file.
+ */
+#define HSE_VALUE           CLK_HSE_HZ
+#define HSI_VALUE           CLK_HSI_HZ
+
+/**
+ * @section Datasheet Limit Checks.
+ */
+_Static_assert((CLK_PLL_M >= 2UL) && (CLK_PLL_M <= 63UL), "PLLM out of range 2..63");
+_Static_assert((CLK_PLL_N >= 50UL) && (CLK_PLL_N <= 432UL), "PLLN out of range 50..432");
+_Static_assert((CLK_PLL_P == 2UL) || (CLK_PLL_P == 4UL) || (CLK_PLL_P == 6UL) || (CLK_PLL_P == 8UL),
+               "PLLP must be 2, 4, 6 or 8");
+_Static_assert((CLK_PLL_Q >= 2UL) && (CLK_PLL_Q <= 15UL), "PLLQ out of range 2..15");
+_Static_assert((CLK_PLL_SRC != CLK_SRC_HSE) || (CLK_HSE_HZ >= 4000000UL && CLK_HSE_HZ <= 26000000UL),
+               "HSE crystal must be 4..26 MHz");
+_Static_assert((CLK_SYSCLK_SRC != CLK_SRC_PLL) ||
+               (CLK_PLL_VCO_IN_HZ >= 950000UL && CLK_PLL_VCO_IN_HZ <= 2100000UL),
+               "PLL VCO input must be 0.95..2.1 MHz");
+_Static_assert((CLK_SYSCLK_SRC != CLK_SRC_PLL) ||
+               (CLK_PLL_VCO_HZ >= 100000000UL && CLK_PLL_VCO_HZ <= 432000000UL),
+               "PLL VCO output must be 100..432 MHz");
+_Static_assert(CLK_PLL_Q_HZ <= 75000000UL, "PLL48CLK above 75 MHz");
+_Static_assert(CLK_SYSCLK_HZ <= 168000000UL, "SYSCLK above 168 MHz requires over-drive");
+_Static_assert(CLK_PCLK1_HZ <= 45000000UL, "PCLK1 above 45 MHz");
+_Static_assert(CLK_PCLK2_HZ <= 90000000UL, "PCLK2 above 90 MHz");
+_Static_assert(CLK_FLASH_LATENCY <= 15UL, "Flash latency out of range");
+
+#endif
@@ -46,6 +46,7 @@
 
 
 #include "stm32f446xx.h"
+#include "clock_profile.h"
 
 #if !defined  (HSE_VALUE) 
   #define HSE_VALUE    ((uint32_t)8000000) /*!< Default value of the External oscillator in Hz */
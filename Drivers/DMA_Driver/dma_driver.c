@@ -0,0 +1,428 @@
+/**
+ * @file    dma_driver.c
+ * @author  Pratik Dhulubulu
+ * @brief   This file implements DMA stream configuration, start/stop control,
+ *          double-buffer status and interrupt callback dispatch.
+ */
+
+#include "dma_driver.h"
+#include "rcc_driver.h"
+#include "timeout_driver.h"
+
+/**
+ * @section Private Macro Definations.
+ */
+#define DMA_STOP_TIMEOUT_US   1000U
+#define DMA_STREAM_STRIDE     0x18U
+
+/* Stream flags relative to the stream's flag offset */
+#define DMA_FLAG_FE           (1UL << 0)
+#define DMA_FLAG_DME          (1UL << 2)
+#define DMA_FLAG_TE           (1UL << 3)
+#define DMA_FLAG_HT           (1UL << 4)
+#define DMA_FLAG_TC           (1UL << 5)
+#define DMA_FLAG_ALL          (DMA_FLAG_FE | DMA_FLAG_DME | DMA_FLAG_TE | DMA_FLAG_HT | DMA_FLAG_TC)
+
+/**
+ * @section Private Type Declarations.
+ */
+typedef struct {
+    fp_dma_callback callback;
+    void *ptr_ctx;
+} DMA_CALLBACK_ENTRY;
+
+/**
+ * @section Private Data Definations.
+ */
+static DMA_CALLBACK_ENTRY dma_callback_table[DMA_STREAM_MAX][DMA_EVENT_MAX];
+static uint8_t dma_stream_claimed[DMA_STREAM_MAX];
+
+/**
+ * @section Private Function Declarations.
+ */
+static uint32_t dmaGetIndex(const DMA_Stream_TypeDef *ptr_stream);
+static DMA_TypeDef *dmaGetController(uint32_t index);
+static uint32_t dmaFlagShift(uint32_t index);
+static uint32_t dmaReadFlags(uint32_t index);
+static void dmaClearFlags(uint32_t index, uint32_t flags);
+
+/**
+ * @section Public Function Definations.
+ */
+
+/**
+ * @brief   This function claims and configures a DMA stream. The stream is left disabled.
+ * @details FIFO is used in direct mode except for memory-to-memory transfers.
+ *          The stream stays claimed until dmaDeinit(), a stream that is
+ *          claimed or still enabled by someone else is never taken over.
+ * @param   ptr_cfg Pointer to DMA configuration structure.
+ * @return  DMA_OK on success, DMA_ERR_CFG on invalid settings, DMA_ERR_BUSY if
+ *          the stream is already claimed or enabled.
+ */
+int dmaInit(const DMA_CONFIG *ptr_cfg)
+{
+    if ((ptr_cfg == NULL) || (ptr_cfg->channel > 7u) || (ptr_cfg->count == 0u))
+    {
+        return DMA_ERR_CFG;
+    }
+
+    uint32_t index = dmaGetIndex(ptr_cfg->ptr_stream);
+
+    if (index >= DMA_STREAM_MAX)
+    {
+        return DMA_ERR_CFG;
+    }
+
+    /* Only DMA2 can do memory-to-memory, and not in circular or double-buffer mode */
+    if ((ptr_cfg->dir == DMA_DIR_M2M) &&
+        ((index < 8u) || (ptr_cfg->circular != 0u) || (ptr_cfg->mem1_addr != 0u)))
+    {
+        return DMA_ERR_CFG;
+    }
+
+    DMA_Stream_TypeDef *ptr_stream = ptr_cfg->ptr_stream;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* EN reads as 0 while the controller clock is off */
+    if ((dma_stream_claimed[index] != 0u) || ((ptr_stream->CR & DMA_SxCR_EN) != 0u))
+    {
+        __set_PRIMASK(primask);
+        return DMA_ERR_BUSY;
+    }
+    dma_stream_claimed[index] = 1u;
+
+    __set_PRIMASK(primask);
+
+    rccPeriphClockEnable((index < 8u) ? RCC_PERIPH_DMA1 : RCC_PERIPH_DMA2);
+
+    uint32_t cr = (ptr_cfg->channel << DMA_SxCR_CHSEL_Pos) |
+                  ((uint32_t)ptr_cfg->priority << DMA_SxCR_PL_Pos) |
+                  ((uint32_t)ptr_cfg->msize << DMA_SxCR_MSIZE_Pos) |
+                  ((uint32_t)ptr_cfg->psize << DMA_SxCR_PSIZE_Pos) |
+                  ((uint32_t)ptr_cfg->dir << DMA_SxCR_DIR_Pos);
+
+    if (ptr_cfg->minc != 0u)
+    {
+        cr |= DMA_SxCR_MINC;
+    }
+    if (ptr_cfg->pinc != 0u)
+    {
+        cr |= DMA_SxCR_PINC;
+    }
+    if (ptr_cfg->circular != 0u)
+    {
+        cr |= DMA_SxCR_CIRC;
+    }
+    if (ptr_cfg->mem1_addr != 0u)
+    {
+        cr |= DMA_SxCR_DBM | DMA_SxCR_CIRC;
+    }
+
+    /* Keep interrupt enables of registered callbacks */
+    cr |= ptr_stream->CR & (DMA_SxCR_HTIE | DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE);
+
+    ptr_stream->PAR  = ptr_cfg->periph_addr;
+    ptr_stream->M0AR = ptr_cfg->mem0_addr;
+    ptr_stream->M1AR = ptr_cfg->mem1_addr;
+    ptr_stream->NDTR = ptr_cfg->count;
+    ptr_stream->FCR  = (ptr_cfg->dir == DMA_DIR_M2M) ? (DMA_SxFCR_DMDIS | DMA_SxFCR_FTH) : 0u;
+    ptr_stream->CR   = cr;
+
+    dmaClearFlags(index, DMA_FLAG_ALL);
+
+    return DMA_OK;
+}
+
+/**
+ * @brief  This function stops a stream, releases the claim taken by dmaInit()
+ *         and its controller clock. Releasing an unclaimed stream is a no-op.
+ * @param  ptr_stream Pointer to DMA stream.
+ * @return None.
+ */
+void dmaDeinit(DMA_Stream_TypeDef *ptr_stream)
+{
+    uint32_t index = dmaGetIndex(ptr_stream);
+
+    if ((index >= DMA_STREAM_MAX) || (dma_stream_claimed[index] == 0u))
+    {
+        return;
+    }
+
+    (void)dmaStop(ptr_stream);
+    ptr_stream->CR = 0u;
+
+    for (uint32_t event = 0u; event < (uint32_t)DMA_EVENT_MAX; event++)
+    {
+        dma_callback_table[index][event].callback = (fp_dma_callback)0;
+    }
+
+    dma_stream_claimed[index] = 0u;
+    rccPeriphClockDisable((index < 8u) ? RCC_PERIPH_DMA1 : RCC_PERIPH_DMA2);
+}
+
+/**
+ * @brief  This function enables a configured stream.
+ * @param  ptr_stream Pointer to DMA stream.
+ * @return None.
+ */
+void dmaStart(DMA_Stream_TypeDef *ptr_stream)
+{
+    uint32_t index = dmaGetIndex(ptr_stream);
+
+    if (index >= DMA_STREAM_MAX)
+    {
+        return;
+    }
+
+    /* EN is refused while any stream flag is still set */
+    dmaClearFlags(index, DMA_FLAG_ALL);
+    ptr_stream->CR |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief  This function disables a stream and waits for the current transfer to end.
+ * @param  ptr_stream Pointer to DMA stream.
+ * @return DMA_OK on success, DMA_ERR_BUSY if EN did not clear in time.
+ */
+int dmaStop(DMA_Stream_TypeDef *ptr_stream)
+{
+    ptr_stream->CR &= ~DMA_SxCR_EN;
+
+    if (timeoutWaitClear(&ptr_stream->CR, DMA_SxCR_EN, DMA_STOP_TIMEOUT_US) != TIMEOUT_OK)
+    {
+        return DMA_ERR_BUSY;
+    }
+
+    return DMA_OK;
+}
+
+/**
+ * @brief  This function returns the number of items left in the current buffer.
+ * @param  ptr_stream Pointer to DMA stream.
+ * @return NDTR value.
+ */
+uint16_t dmaGetRemaining(const DMA_Stream_TypeDef *ptr_stream)
+{
+    return (uint16_t)ptr_stream->NDTR;
+}
+
+/**
+ * @brief  This function returns the memory buffer in use in double-buffer mode.
+ * @param  ptr_stream Pointer to DMA stream.
+ * @return 0 for M0AR, 1 for M1AR.
+ */
+uint8_t dmaGetCurrentTarget(const DMA_Stream_TypeDef *ptr_stream)
+{
+    return (uint8_t)((ptr_stream->CR & DMA_SxCR_CT) >> DMA_SxCR_CT_Pos);
+}
+
+/**
+ * @brief   This function registers a callback for a stream event.
+ * @details The matching interrupt enable is set or cleared with the callback.
+ * @param   ptr_stream Pointer to DMA stream.
+ * @param   event Stream event.
+ * @param   ptr_callback Pointer to user handler function, NULL to remove.
+ * @param   ptr_ctx Context pointer passed to the handler.
+ * @return  None.
+ */
+void dmaRegisterCallback(DMA_Stream_TypeDef *ptr_stream, DMA_EVENT event, fp_dma_callback ptr_callback, void *ptr_ctx)
+{
+    static const uint32_t ie_table[DMA_EVENT_MAX] = {
+        DMA_SxCR_HTIE, DMA_SxCR_TCIE, DMA_SxCR_TEIE | DMA_SxCR_DMEIE
+    };
+    uint32_t index = dmaGetIndex(ptr_stream);
+
+    if ((index >= DMA_STREAM_MAX) || (event >= DMA_EVENT_MAX))
+    {
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    dma_callback_table[index][event].callback = ptr_callback;
+    dma_callback_table[index][event].ptr_ctx = ptr_ctx;
+
+    if (ptr_callback != (fp_dma_callback)0)
+    {
+        ptr_stream->CR |= ie_table[event];
+    }
+    else
+    {
+        ptr_stream->CR &= ~ie_table[event];
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  This function sets priority and enables the NVIC vector of a stream.
+ * @param  ptr_stream Pointer to DMA stream.
+ * @param  priority NVIC priority.
+ * @return None.
+ */
+void dmaEnableIrq(DMA_Stream_TypeDef *ptr_stream, uint8_t priority)
+{
+    static const IRQn_Type dma_irq_table[DMA_STREAM_MAX] = {
+        DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn,
+        DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn,
+        DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn,
+        DMA2_Stream4_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn
+    };
+    uint32_t index = dmaGetIndex(ptr_stream);
+
+    if (index >= DMA_STREAM_MAX)
+    {
+        return;
+    }
+
+    NVIC_SetPriority(dma_irq_table[index], priority);
+    NVIC_EnableIRQ(dma_irq_table[index]);
+}
+
+/**
+ * @brief  This function handles a stream interrupt and dispatches callbacks.
+ * @param  ptr_stream Pointer to DMA stream that generated interrupt.
+ * @return None.
+ */
+void dmaHandleIrq(DMA_Stream_TypeDef *ptr_stream)
+{
+    uint32_t index = dmaGetIndex(ptr_stream);
+
+    if (index >= DMA_STREAM_MAX)
+    {
+        return;
+    }
+
+    uint32_t cr = ptr_stream->CR;
+    uint32_t flags = dmaReadFlags(index);
+
+    /* Only serve flags whose interrupt is enabled */
+    if ((cr & DMA_SxCR_HTIE) == 0u)
+    {
+        flags &= ~DMA_FLAG_HT;
+    }
+    if ((cr & DMA_SxCR_TCIE) == 0u)
+    {
+        flags &= ~DMA_FLAG_TC;
+    }
+    if ((cr & DMA_SxCR_TEIE) == 0u)
+    {
+        flags &= ~DMA_FLAG_TE;
+    }
+    if ((cr & DMA_SxCR_DMEIE) == 0u)
+    {
+        flags &= ~DMA_FLAG_DME;
+    }
+    flags &= ~DMA_FLAG_FE;
+
+    if (flags == 0u)
+    {
+        return;
+    }
+
+    dmaClearFlags(index, flags);
+
+    if (((flags & (DMA_FLAG_TE | DMA_FLAG_DME)) != 0u) &&
+        (dma_callback_table[index][DMA_EVENT_ERROR].callback != (fp_dma_callback)0))
+    {
+        dma_callback_table[index][DMA_EVENT_ERROR].callback(dma_callback_table[index][DMA_EVENT_ERROR].ptr_ctx);
+    }
+
+    if (((flags & DMA_FLAG_HT) != 0u) &&
+        (dma_callback_table[index][DMA_EVENT_HALF].callback != (fp_dma_callback)0))
+    {
+        dma_callback_table[index][DMA_EVENT_HALF].callback(dma_callback_table[index][DMA_EVENT_HALF].ptr_ctx);
+    }
+
+    if (((flags & DMA_FLAG_TC) != 0u) &&
+        (dma_callback_table[index][DMA_EVENT_FULL].callback != (fp_dma_callback)0))
+    {
+        dma_callback_table[index][DMA_EVENT_FULL].callback(dma_callback_table[index][DMA_EVENT_FULL].ptr_ctx);
+    }
+}
+
+/**
+ * @section Private Function Definations.
+ */
+
+/**
+ * @brief  This function returns the stream index, DMA1 streams 0-7 then DMA2 streams 8-15.
+ * @param  ptr_stream Pointer to DMA stream.
+ * @return Stream index, DMA_STREAM_MAX if not a stream.
+ */
+static uint32_t dmaGetIndex(const DMA_Stream_TypeDef *ptr_stream)
+{
+    uint32_t addr = (uint32_t)ptr_stream;
+
+    if ((addr >= DMA1_Stream0_BASE) && (addr < (DMA1_Stream0_BASE + (8u * DMA_STREAM_STRIDE))) &&
+        (((addr - DMA1_Stream0_BASE) % DMA_STREAM_STRIDE) == 0u))
+    {
+        return (addr - DMA1_Stream0_BASE) / DMA_STREAM_STRIDE;
+    }
+
+    if ((addr >= DMA2_Stream0_BASE) && (addr < (DMA2_Stream0_BASE + (8u * DMA_STREAM_STRIDE))) &&
+        (((addr - DMA2_Stream0_BASE) % DMA_STREAM_STRIDE) == 0u))
+    {
+        return 8u + ((addr - DMA2_Stream0_BASE) / DMA_STREAM_STRIDE);
+    }
+
+    return DMA_STREAM_MAX;
+}
+
+/**
+ * @brief  This function returns the controller of a stream index.
+ * @param  index Stream index.
+ * @return DMA1 or DMA2.
+ */
+static DMA_TypeDef *dmaGetController(uint32_t index)
+{
+    return (index < 8u) ? DMA1 : DMA2;
+}
+
+/**
+ * @brief  This function returns the bit offset of a stream in the ISR/IFCR registers.
+ * @param  index Stream index.
+ * @return Bit offset.
+ */
+static uint32_t dmaFlagShift(uint32_t index)
+{
+    static const uint8_t shift_table[4] = { 0u, 6u, 16u, 22u };
+
+    return shift_table[index & 3u];
+}
+
+/**
+ * @brief  This function reads the flags of a stream.
+ * @param  index Stream index.
+ * @return Stream flags aligned to bit 0.
+ */
+static uint32_t dmaReadFlags(uint32_t index)
+{
+    DMA_TypeDef *ptr_dma = dmaGetController(index);
+    uint32_t isr = ((index & 7u) < 4u) ? ptr_dma->LISR : ptr_dma->HISR;
+
+    return (isr >> dmaFlagShift(index)) & DMA_FLAG_ALL;
+}
+
+/**
+ * @brief  This function clears flags of a stream.
+ * @param  index Stream index.
+ * @param  flags Stream flags aligned to bit 0.
+ * @return None.
+ */
+static void dmaClearFlags(uint32_t index, uint32_t flags)
+{
+    DMA_TypeDef *ptr_dma = dmaGetController(index);
+
+    if ((index & 7u) < 4u)
+    {
+        ptr_dma->LIFCR = flags << dmaFlagShift(index);
+    }
+    else
+    {
+        ptr_dma->HIFCR = flags << dmaFlagShift(index);
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * @file    dma_driver.h
+ * @author  Pratik Dhulubulu
+ * @brief   DMA Stream Driver Interface.
+ */
+
+#ifndef DMA_DRIVER_H
+#define DMA_DRIVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "stm32f446xx.h"
+
+/**
+ * @section Public Macro Definations.
+ */
+#define DMA_OK          0
+#define DMA_ERR_CFG    -1
+#define DMA_ERR_BUSY   -2
+
+#define DMA_STREAM_MAX  16U
+
+/**
+ * @section Public Type Declarations.
+ */
+typedef enum {
+    DMA_DIR_P2M = 0u,
+    DMA_DIR_M2P,
+    DMA_DIR_M2M
+} DMA_DIR;
+
+typedef enum {
+    DMA_SIZE_8 = 0u,
+    DMA_SIZE_16,
+    DMA_SIZE_32
+} DMA_SIZE;
+
+typedef enum {
+    DMA_PRIO_LOW = 0u,
+    DMA_PRIO_MEDIUM,
+    DMA_PRIO_HIGH,
+    DMA_PRIO_VERY_HIGH
+} DMA_PRIORITY;
+
+typedef enum {
+    DMA_EVENT_HALF = 0u,
+    DMA_EVENT_FULL,
+    DMA_EVENT_ERROR,
+    DMA_EVENT_MAX
+} DMA_EVENT;
+
+/**
+ * @brief Callback function pointer for DMA stream events.
+ */
+typedef void (*fp_dma_callback)(void *ptr_ctx);
+
+typedef struct {
+    DMA_Stream_TypeDef *ptr_stream;
+    uint32_t     channel;       /* Request channel 0..7 */
+    DMA_DIR      dir;
+    DMA_SIZE     psize;
+    DMA_SIZE     msize;
+    uint8_t      pinc;
+    uint8_t      minc;
+    uint8_t      circular;
+    DMA_PRIORITY priority;
+    uint32_t     periph_addr;
+    uint32_t     mem0_addr;
+    uint32_t     mem1_addr;     /* Non-zero selects double-buffer mode */
+    uint16_t     count;
+} DMA_CONFIG;
+
+/**
+ * @section Public Function Declarations.
+ */
+int dmaInit(const DMA_CONFIG *ptr_cfg);
+void dmaDeinit(DMA_Stream_TypeDef *ptr_stream);
+void dmaStart(DMA_Stream_TypeDef *ptr_stream);
+int dmaStop(DMA_Stream_TypeDef *ptr_stream);
+uint16_t dmaGetRemaining(const DMA_Stream_TypeDef *ptr_stream);
+uint8_t dmaGetCurrentTarget(const DMA_Stream_TypeDef *ptr_stream);
+void dmaRegisterCallback(DMA_Stream_TypeDef *ptr_stream, DMA_EVENT event, fp_dma_callback ptr_callback, void *ptr_ctx);
+void dmaEnableIrq(DMA_Stream_TypeDef *ptr_stream, uint8_t priority);
+void dmaHandleIrq(DMA_Stream_TypeDef *ptr_stream);
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file    dwt_driver.c
+ * @author  Pratik Dhulubulu
+ * @brief   This file implements the DWT cycle counter and cycle-accurate
+ *          busy-wait delays with call overhead compensation.
+ */
+
+#include "dwt_driver.h"
+#include "rcc_driver.h"
+
+/**
+ * @section Private Data Definations.
+ */
+static uint32_t dwt_cycles_per_us = 0u;
+static uint32_t dwt_overhead = 0u;
+
+/**
+ * @section Private Function Declarations.
+ */
+static void dwtWaitFrom(uint32_t start, uint32_t cycles);
+static void dwtClockChanged(void);
+
+/**
+ * @section Public Function Definations.
+ */
+
+/**
+ * @brief   This function enables the cycle counter and calibrates the delay overhead.
+ * @details The cycles-per-microsecond factor follows RCC driver clock changes.
+ * @return  DWT_OK on success, DWT_ERR_NOCYC if the core has no cycle counter.
+ */
+int dwtInit(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    if ((DWT->CTRL & DWT_CTRL_NOCYCCNT_Msk) != 0u)
+    {
+        return DWT_ERR_NOCYC;
+    }
+
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    dwt_cycles_per_us = SystemCoreClock / 1000000u;
+
+    /* Time a zero-length delay, which is pure call and loop-entry cost */
+    dwt_overhead = 0u;
+    uint32_t start = DWT->CYCCNT;
+    dwtDelayCycles(0u);
+    dwt_overhead = DWT->CYCCNT - start;
+
+    (void)rccRegisterClockCallback(dwtClockChanged);
+
+    return DWT_OK;
+}
+
+/**
+ * @brief  This function returns the free-running cycle counter.
+ * @return CYCCNT value.
+ */
+uint32_t dwtGetCycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief  This function returns the core cycles per microsecond.
+ * @return Cycles per microsecond captured by dwtInit().
+ */
+uint32_t dwtGetCyclesPerUs(void)
+{
+    return dwt_cycles_per_us;
+}
+
+/**
+ * @brief  This function busy-waits for a number of core cycles.
+ * @param  cycles Cycles to wait, including the call itself.
+ * @return None.
+ */
+void dwtDelayCycles(uint32_t cycles)
+{
+    uint32_t start = DWT->CYCCNT;
+
+    if (cycles > dwt_overhead)
+    {
+        dwtWaitFrom(start, cycles - dwt_overhead);
+    }
+}
+
+/**
+ * @brief  This function busy-waits for a number of microseconds.
+ * @param  us Microseconds to wait.
+ * @return None.
+ */
+void dwtDelayUs(uint32_t us)
+{
+    uint32_t start = DWT->CYCCNT;
+    uint32_t max_us = UINT32_MAX / ((dwt_cycles_per_us != 0u) ? dwt_cycles_per_us : 1u);
+
+    /* Split waits that would not fit in one CYCCNT period */
+    while (us > max_us)
+    {
+        dwtWaitFrom(start, max_us * dwt_cycles_per_us);
+        start += max_us * dwt_cycles_per_us;
+        us -= max_us;
+    }
+
+    uint32_t cycles = us * dwt_cycles_per_us;
+
+    if (cycles > dwt_overhead)
+    {
+        dwtWaitFrom(start, cycles - dwt_overhead);
+    }
+}
+
+/**
+ * @section Private Function Definations.
+ */
+
+/**
+ * @brief  This function spins until cycles have elapsed since start.
+ * @param  start CYCCNT reference value.
+ * @param  cycles Cycles to wait.
+ * @return None.
+ */
+static void dwtWaitFrom(uint32_t start, uint32_t cycles)
+{
+    while ((DWT->CYCCNT - start) < cycles)
+    {
+        __NOP();
+    }
+}
+
+/**
+ * @brief  This function updates the microsecond scale after a clock change.
+ * @return None.
+ */
+static void dwtClockChanged(void)
+{
+    dwt_cycles_per_us = SystemCoreClock / 1000000u;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file    dwt_driver.h
+ * @author  Pratik Dhulubulu
+ * @brief   DWT Cycle Counter Driver Interface.
+ */
+
+#ifndef DWT_DRIVER_H
+#define DWT_DRIVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "stm32f446xx.h"
+
+/**
+ * @section Public Macro Definations.
+ */
+#define DWT_OK          0
+#define DWT_ERR_NOCYC  -1
+
+/**
+ * @section Public Function Declarations.
+ */
+int dwtInit(void);
+uint32_t dwtGetCycles(void);
+uint32_t dwtGetCyclesPerUs(void);
+void dwtDelayCycles(uint32_t cycles);
+void dwtDelayUs(uint32_t us);
+
+#endif
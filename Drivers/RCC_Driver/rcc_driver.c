@@ -6,23 +6,55 @@
  */
  
 #include "rcc_driver.h"
+#include "gpio_driver.h"
+#include "timeout_driver.h"
 
 /**
  * @brief Public Macro Definations.
  */
-#define TIMEOUT      50000U
-#define RCC_OK       0
-#define RCC_ERR_CFG -1
-#define RCC_ERR_HSE -2
-#define RCC_ERR_PLL -3
-#define RCC_ERR_HSI -4
-#define RCC_ERR_SYS -5
-#define HSE_VALUE    ((uint32_t)8000000)
+#define TIMEOUT_US   100000U
+
+/**
+ * @section Private Data Definations.
+ */
+static volatile uint32_t * const rcc_enr_table[RCC_BUS_MAX] = {
+    &RCC->AHB1ENR, &RCC->AHB2ENR, &RCC->AHB3ENR, &RCC->APB1ENR, &RCC->APB2ENR
+};
+
+static volatile uint32_t * const rcc_lpenr_table[RCC_BUS_MAX] = {
+    &RCC->AHB1LPENR, &RCC->AHB2LPENR, &RCC->AHB3LPENR, &RCC->APB1LPENR, &RCC->APB2LPENR
+};
+
+static volatile uint32_t * const rcc_rstr_table[RCC_BUS_MAX] = {
+    &RCC->AHB1RSTR, &RCC->AHB2RSTR, &RCC->AHB3RSTR, &RCC->APB1RSTR, &RCC->APB2RSTR
+};
+
+/* Number of active users per peripheral clock enable bit. */
+static uint8_t rcc_ref_count[RCC_BUS_MAX][32];
+
+/* Clock cache, initialised to the reset state (HSI, no prescalers). */
+static RCC_CLOCKS rcc_clocks = {
+    .hsi_hz     = CLK_HSI_HZ,
+    .hse_hz     = CLK_HSE_HZ,
+    .lsi_hz     = RCC_LSI_HZ,
+    .lse_hz     = RCC_LSE_HZ,
+    .sysclk_hz  = CLK_HSI_HZ,
+    .hclk_hz    = CLK_HSI_HZ,
+    .pclk1_hz   = CLK_HSI_HZ,
+    .pclk2_hz   = CLK_HSI_HZ,
+    .timclk1_hz = CLK_HSI_HZ,
+    .timclk2_hz = CLK_HSI_HZ
+};
+
+/* Drivers that derive timing from the bus clocks. */
+static fp_rcc_clock_callback fp_rcc_clock_callback_table[RCC_CLOCK_CB_MAX] = { (fp_rcc_clock_callback)0 };
 
 /**
  * @section Private Function Declarations
  */
 static int waitForFlag(volatile uint32_t *ptr_reg, uint32_t flag);
+static int rccCaptureFrequency(TIM_TypeDef *ptr_tim, volatile uint32_t *ptr_ccr, uint32_t flag,
+                               uint32_t mask, uint32_t tim_hz, uint32_t *ptr_hz);
 
 /**
  * @section Public Function Definations.
@@ -59,13 +91,13 @@ int rccSystemClockConfig(const RCC_SYS_CFG *ptr_config)
         RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_HSE;
 
         /* Wait until HSE is used as SYSCLK */
-        while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_HSE)
+        if (timeoutWaitValue(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_HSE, TIMEOUT_US) != TIMEOUT_OK)
         {
-            __NOP();
+            return RCC_ERR_SYS;
         }
 
-        /* Update SystemCoreClock variable */
-        SystemCoreClockUpdate();
+        /* Update clock cache and SystemCoreClock variable */
+        rccClockCacheUpdate();
         
         return RCC_OK;
     }
@@ -128,13 +160,13 @@ int rccSystemClockConfig(const RCC_SYS_CFG *ptr_config)
         RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_PLL;
 
         /* Wait until PLL is used as SYSCLK */
-        while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL)
+        if (timeoutWaitValue(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_PLL, TIMEOUT_US) != TIMEOUT_OK)
         {
-            __NOP();
+            return RCC_ERR_SYS;
         }
 
-        /* Update SystemCoreClock variable */
-        SystemCoreClockUpdate();
+        /* Update clock cache and SystemCoreClock variable */
+        rccClockCacheUpdate();
         return RCC_OK;
     }
 
@@ -156,13 +188,13 @@ int rccSystemClockConfig(const RCC_SYS_CFG *ptr_config)
         /* Switch SYSCLK to HSI */
         RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_HSI;
 
-        while ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_HSI)
+        if (timeoutWaitValue(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_HSI, TIMEOUT_US) != TIMEOUT_OK)
         {
-            __NOP();
+            return RCC_ERR_SYS;
         }
 
-        /* Update SystemCoreClock variable */
-        SystemCoreClockUpdate();
+        /* Update clock cache and SystemCoreClock variable */
+        rccClockCacheUpdate();
 
         return RCC_OK;
     }
@@ -170,6 +202,38 @@ int rccSystemClockConfig(const RCC_SYS_CFG *ptr_config)
     return RCC_ERR_SYS;
 }
 
+/**
+ * @brief  This function configures the clock tree from the compile-time board profile.
+ * @return RCC_OK on success, otherwise error code.
+ */
+int rccApplyClockProfile(void)
+{
+    const RCC_SYS_CFG config = {
+        .CLK_SOURCE     = (RCC_CLK_SRC)CLK_SYSCLK_SRC,
+        .PLL = {
+            .SRC = (uint32_t)CLK_PLL_SRC,
+            .M   = CLK_PLL_M,
+            .N   = CLK_PLL_N,
+            .P   = CLK_PLL_P,
+            .Q   = CLK_PLL_Q
+        },
+        .AHB_PRESCALER  = CLK_HPRE_BITS,
+        .APB1_PRESCALER = CLK_PPRE1_BITS,
+        .APB2_PRESCALER = CLK_PPRE2_BITS,
+        .FLASH_LATENCY  = CLK_FLASH_LATENCY
+    };
+
+#if (CLK_HSE_BYPASS != 0)
+    /* HSEBYP can only be written while HSE is off */
+    if ((RCC->CR & RCC_CR_HSEON) == 0u)
+    {
+        RCC->CR |= RCC_CR_HSEBYP;
+    }
+#endif
+
+    return rccSystemClockConfig(&config);
+}
+
 /**
  * @brief This function Enables AHB1 peripheral clocks.
  * @param mask Bitmask of peripherals to enable.
@@ -188,6 +252,42 @@ void rccDisableAHB1(uint32_t mask)
     RCC->AHB1ENR &= ~mask;
 }
 
+/**
+ * @brief This function Enables AHB2 peripheral clocks.
+ * @param mask Bitmask of peripherals to enable.
+ */
+void rccEnableAHB2(uint32_t mask)
+{
+    RCC->AHB2ENR |= mask;
+}
+
+/**
+ * @brief This function Disables AHB2 peripheral clocks.
+ * @param mask Bitmask of peripherals to disable.
+ */
+void rccDisableAHB2(uint32_t mask)
+{
+    RCC->AHB2ENR &= ~mask;
+}
+
+/**
+ * @brief This function Enables AHB3 peripheral clocks.
+ * @param mask Bitmask of peripherals to enable.
+ */
+void rccEnableAHB3(uint32_t mask)
+{
+    RCC->AHB3ENR |= mask;
+}
+
+/**
+ * @brief This function Disables AHB3 peripheral clocks.
+ * @param mask Bitmask of peripherals to disable.
+ */
+void rccDisableAHB3(uint32_t mask)
+{
+    RCC->AHB3ENR &= ~mask;
+}
+
 /**
  * @brief This function Enables APB1 peripheral clocks.
  * @param mask Bitmask of peripherals to enable.
@@ -250,7 +350,7 @@ void rccResetAPB2(uint32_t mask)
  */
 uint32_t rccGetSYSCLK(void)
 {
-    return SystemCoreClock;
+    return rcc_clocks.sysclk_hz;
 }
 
 /**
@@ -259,50 +359,615 @@ uint32_t rccGetSYSCLK(void)
  */
 uint32_t rccGetHCLK(void)
 {
-    uint32_t hclk = 0;
+    return rcc_clocks.hclk_hz;
+}
 
-    if ((RCC->CFGR & RCC_CFGR_HPRE) != 0)
+/**
+ * @brief  This function returns current APB1 peripheral clock (PCLK1) frequency.
+ * @return PCLK1 in Hz.
+ */
+uint32_t rccGetPCLK1(void)
+{
+    return rcc_clocks.pclk1_hz;
+}
+
+/**
+ * @brief  This function returns current APB2 peripheral clock (PCLK2) frequency.
+ * @return PCLK2 in Hz.
+ */
+uint32_t rccGetPCLK2(void)
+{
+    return rcc_clocks.pclk2_hz;
+}
+
+/**
+ * @brief  This function returns the kernel clock of timers on APB1.
+ * @return Timer clock in Hz.
+ */
+uint32_t rccGetTIMCLK1(void)
+{
+    return rcc_clocks.timclk1_hz;
+}
+
+/**
+ * @brief  This function returns the kernel clock of timers on APB2.
+ * @return Timer clock in Hz.
+ */
+uint32_t rccGetTIMCLK2(void)
+{
+    return rcc_clocks.timclk2_hz;
+}
+
+/**
+ * @brief This function copies the clock cache.
+ * @param ptr_clocks Pointer to destination structure.
+ */
+void rccGetClocks(RCC_CLOCKS *ptr_clocks)
+{
+    if (ptr_clocks != NULL)
     {
-        hclk = SystemCoreClock >> ((RCC->CFGR & RCC_CFGR_HPRE) >> 4);
+        *ptr_clocks = rcc_clocks;
+    }
+}
+
+/**
+ * @brief   This function recomputes the clock cache from the RCC registers.
+ * @details Oscillator frequencies are taken from the cache, so values measured by
+ *          rccMeasureClock() or rccCalibrateHSI() propagate to every bus clock.
+ *          Registered clock callbacks are notified afterwards.
+ */
+void rccClockCacheUpdate(void)
+{
+    static const uint8_t ahb_shift[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9 };
+    static const uint8_t apb_shift[8]  = { 0, 0, 0, 0, 1, 2, 3, 4 };
+    uint32_t cfgr = RCC->CFGR;
+    uint32_t sysclk;
+
+    switch (cfgr & RCC_CFGR_SWS)
+    {
+        case RCC_CFGR_SWS_HSE:
+            sysclk = rcc_clocks.hse_hz;
+            break;
+
+        case RCC_CFGR_SWS_PLL:
+        {
+            uint32_t pllcfgr = RCC->PLLCFGR;
+            uint32_t pll_in = ((pllcfgr & RCC_PLLCFGR_PLLSRC) != 0u) ? rcc_clocks.hse_hz : rcc_clocks.hsi_hz;
+            uint32_t pllm = pllcfgr & RCC_PLLCFGR_PLLM;
+            uint32_t plln = (pllcfgr & RCC_PLLCFGR_PLLN) >> RCC_PLLCFGR_PLLN_Pos;
+            uint32_t pllp = (((pllcfgr & RCC_PLLCFGR_PLLP) >> RCC_PLLCFGR_PLLP_Pos) + 1u) * 2u;
+
+            sysclk = (pllm != 0u) ? (uint32_t)(((uint64_t)pll_in * plln) / (pllm * pllp)) : 0u;
+            break;
+        }
+
+        default:
+            sysclk = rcc_clocks.hsi_hz;
+            break;
+    }
+
+    uint32_t ppre1 = apb_shift[(cfgr & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+    uint32_t ppre2 = apb_shift[(cfgr & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
+
+    rcc_clocks.sysclk_hz  = sysclk;
+    rcc_clocks.hclk_hz    = sysclk >> ahb_shift[(cfgr & RCC_CFGR_HPRE) >> RCC_CFGR_HPRE_Pos];
+    rcc_clocks.pclk1_hz   = rcc_clocks.hclk_hz >> ppre1;
+    rcc_clocks.pclk2_hz   = rcc_clocks.hclk_hz >> ppre2;
+    rcc_clocks.timclk1_hz = (ppre1 == 0u) ? rcc_clocks.pclk1_hz : (rcc_clocks.pclk1_hz * 2u);
+    rcc_clocks.timclk2_hz = (ppre2 == 0u) ? rcc_clocks.pclk2_hz : (rcc_clocks.pclk2_hz * 2u);
+
+    SystemCoreClock = rcc_clocks.hclk_hz;
+
+    for (uint32_t i = 0u; i < RCC_CLOCK_CB_MAX; i++)
+    {
+        if (fp_rcc_clock_callback_table[i] != (fp_rcc_clock_callback)0)
+        {
+            fp_rcc_clock_callback_table[i]();
+        }
+    }
+}
+
+/**
+ * @brief   This function registers a callback run after every clock tree change.
+ * @details Registering the same callback twice has no effect.
+ * @param   ptr_callback Pointer to handler function.
+ * @return  RCC_OK on success, RCC_ERR_CFG for NULL, RCC_ERR_REF if the table is full.
+ */
+int rccRegisterClockCallback(fp_rcc_clock_callback ptr_callback)
+{
+    if (ptr_callback == (fp_rcc_clock_callback)0)
+    {
+        return RCC_ERR_CFG;
+    }
+
+    for (uint32_t i = 0u; i < RCC_CLOCK_CB_MAX; i++)
+    {
+        if (fp_rcc_clock_callback_table[i] == ptr_callback)
+        {
+            return RCC_OK;
+        }
+    }
+
+    for (uint32_t i = 0u; i < RCC_CLOCK_CB_MAX; i++)
+    {
+        if (fp_rcc_clock_callback_table[i] == (fp_rcc_clock_callback)0)
+        {
+            fp_rcc_clock_callback_table[i] = ptr_callback;
+            return RCC_OK;
+        }
+    }
+
+    return RCC_ERR_REF;
+}
+
+/**
+ * @brief   This function measures an oscillator against the timer kernel clock.
+ * @details LSI and LSE are routed to TIM5 CH4, HSE_RTC to TIM11 CH1. The input
+ *          capture prescaler averages 8 periods per capture and RCC_MEAS_CAPTURES
+ *          captures are accumulated. The result is stored in the clock cache.
+ *          The measurement timer must not be in use.
+ * @note    The result is relative to SYSCLK, so measuring the oscillator that
+ *          drives SYSCLK only returns the cached value.
+ * @param   src Oscillator to measure.
+ * @param   ptr_hz Pointer to store the measured frequency in Hz.
+ * @return  RCC_OK on success, otherwise error code.
+ */
+int rccMeasureClock(RCC_MEAS_SRC src, uint32_t *ptr_hz)
+{
+    uint32_t rtcpre = 1u;
+    uint32_t rtcpre_saved = RCC->CFGR & RCC_CFGR_RTCPRE;
+    int status;
+
+    if ((ptr_hz == NULL) || ((src != RCC_MEAS_LSI) && (src != RCC_MEAS_LSE) && (src != RCC_MEAS_HSE)))
+    {
+        return RCC_ERR_CFG;
+    }
+
+    /* Never take over a timer that is in use by the application */
+    if (rccPeriphIsClocked((src == RCC_MEAS_HSE) ? RCC_PERIPH_TIM11 : RCC_PERIPH_TIM5) != 0u)
+    {
+        return RCC_ERR_BUSY;
+    }
+
+    if (src == RCC_MEAS_LSI)
+    {
+        RCC->CSR |= RCC_CSR_LSION;
+        if (waitForFlag(&RCC->CSR, RCC_CSR_LSIRDY) != 0)
+        {
+            return RCC_ERR_OSC;
+        }
+    }
+    else if (src == RCC_MEAS_LSE)
+    {
+        /* LSE start-up takes up to seconds, it must already be running */
+        if ((RCC->BDCR & RCC_BDCR_LSERDY) == 0u)
+        {
+            return RCC_ERR_OSC;
+        }
+    }
+    else if (src == RCC_MEAS_HSE)
+    {
+        if ((RCC->CR & RCC_CR_HSERDY) == 0u)
+        {
+            return RCC_ERR_HSE;
+        }
+
+        /* Divide HSE down to about 1 MHz so TIM11 counts fit in 16 bits */
+        rtcpre = (rcc_clocks.hse_hz + 999999u) / 1000000u;
+        rtcpre = (rtcpre < 2u) ? 2u : ((rtcpre > 31u) ? 31u : rtcpre);
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_RTCPRE) | (rtcpre << RCC_CFGR_RTCPRE_Pos);
+    }
+
+    if (src == RCC_MEAS_HSE)
+    {
+        rccPeriphClockEnable(RCC_PERIPH_TIM11);
+
+        TIM11->CR1   = 0u;
+        TIM11->PSC   = 0u;
+        TIM11->ARR   = 0xFFFFu;
+        TIM11->OR    = (2u << TIM_OR_TI1_RMP_Pos);
+        TIM11->CCMR1 = (1u << TIM_CCMR1_CC1S_Pos) | (3u << TIM_CCMR1_IC1PSC_Pos);
+        TIM11->CCER  = TIM_CCER_CC1E;
+        TIM11->EGR   = TIM_EGR_UG;
+
+        status = rccCaptureFrequency(TIM11, &TIM11->CCR1, TIM_SR_CC1IF, 0xFFFFu,
+                                     rcc_clocks.timclk2_hz, ptr_hz);
+
+        TIM11->CR1  = 0u;
+        TIM11->CCER = 0u;
+        TIM11->OR   = 0u;
+        rccPeriphClockDisable(RCC_PERIPH_TIM11);
+
+        /* The RTC may be clocked from HSE_RTC, give it back its prescaler */
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_RTCPRE) | rtcpre_saved;
+
+        if (status == RCC_OK)
+        {
+            *ptr_hz *= rtcpre;
+            rcc_clocks.hse_hz = *ptr_hz;
+        }
     }
     else
     {
-        hclk = SystemCoreClock;
+        rccPeriphClockEnable(RCC_PERIPH_TIM5);
+
+        TIM5->CR1   = 0u;
+        TIM5->PSC   = 0u;
+        TIM5->ARR   = 0xFFFFFFFFu;
+        TIM5->OR    = (((src == RCC_MEAS_LSI) ? 1u : 2u) << TIM_OR_TI4_RMP_Pos);
+        TIM5->CCMR2 = (1u << TIM_CCMR2_CC4S_Pos) | (3u << TIM_CCMR2_IC4PSC_Pos);
+        TIM5->CCER  = TIM_CCER_CC4E;
+        TIM5->EGR   = TIM_EGR_UG;
+
+        status = rccCaptureFrequency(TIM5, &TIM5->CCR4, TIM_SR_CC4IF, 0xFFFFFFFFu,
+                                     rcc_clocks.timclk1_hz, ptr_hz);
+
+        TIM5->CR1  = 0u;
+        TIM5->CCER = 0u;
+        TIM5->OR   = 0u;
+        rccPeriphClockDisable(RCC_PERIPH_TIM5);
+
+        if (status == RCC_OK)
+        {
+            if (src == RCC_MEAS_LSI)
+            {
+                rcc_clocks.lsi_hz = *ptr_hz;
+            }
+            else
+            {
+                rcc_clocks.lse_hz = *ptr_hz;
+            }
+        }
+    }
+
+    if ((status == RCC_OK) && (src == RCC_MEAS_HSE))
+    {
+        rccClockCacheUpdate();
     }
 
-    return hclk;
+    return status;
 }
 
 /**
- * @brief  This function returns current APB1 peripheral clock (PCLK1) frequency.
- * @return PCLK1 in Hz.
+ * @brief   This function trims HSI against the LSE crystal.
+ * @details SYSCLK must be derived from HSI so that the timer clock follows the
+ *          trim. Each step measures LSE, derives the real HSI frequency and moves
+ *          HSITRIM towards 16 MHz; the trim with the smallest error is kept and
+ *          the measured HSI frequency is written to the clock cache.
+ * @param   ptr_hsi_hz Optional pointer to store the calibrated HSI frequency in Hz.
+ * @return  RCC_OK on success, otherwise error code.
  */
-uint32_t rccGetPCLK1(void)
+int rccCalibrateHSI(uint32_t *ptr_hsi_hz)
 {
-    uint32_t pclk1 = rccGetHCLK();
+    uint32_t cfgr = RCC->CFGR;
+    uint32_t sws = cfgr & RCC_CFGR_SWS;
 
-    if (((RCC->CFGR & RCC_CFGR_PPRE1) >> 10) != 0)
+    if ((sws == RCC_CFGR_SWS_HSE) ||
+        ((sws == RCC_CFGR_SWS_PLL) && ((RCC->PLLCFGR & RCC_PLLCFGR_PLLSRC) != 0u)))
     {
-        pclk1 = pclk1 >> (((RCC->CFGR & RCC_CFGR_PPRE1) >> 10) - 1);
+        return RCC_ERR_CFG;
     }
 
-    return pclk1;
+    uint32_t trim = (RCC->CR & RCC_CR_HSITRIM) >> RCC_CR_HSITRIM_Pos;
+    uint32_t best_trim = trim;
+    uint32_t best_hz = rcc_clocks.hsi_hz;
+    uint32_t best_err = UINT32_MAX;
+
+    for (uint32_t step = 0u; step <= (RCC_CR_HSITRIM_Msk >> RCC_CR_HSITRIM_Pos); step++)
+    {
+        uint32_t lse_hz;
+        int status = rccMeasureClock(RCC_MEAS_LSE, &lse_hz);
+
+        if ((status != RCC_OK) || (lse_hz == 0u))
+        {
+            return (status != RCC_OK) ? status : RCC_ERR_OSC;
+        }
+
+        /* LSE appears fast when HSI is slow and vice versa */
+        uint32_t hsi_hz = (uint32_t)(((uint64_t)rcc_clocks.hsi_hz * RCC_LSE_HZ) / lse_hz);
+        uint32_t err = (hsi_hz > CLK_HSI_HZ) ? (hsi_hz - CLK_HSI_HZ) : (CLK_HSI_HZ - hsi_hz);
+
+        rcc_clocks.hsi_hz = hsi_hz;
+        rcc_clocks.lse_hz = RCC_LSE_HZ;
+        rccClockCacheUpdate();
+
+        if (err >= best_err)
+        {
+            break;
+        }
+
+        best_err = err;
+        best_trim = trim;
+        best_hz = hsi_hz;
+
+        if ((hsi_hz > CLK_HSI_HZ) && (trim > 0u))
+        {
+            trim--;
+        }
+        else if ((hsi_hz < CLK_HSI_HZ) && (trim < (RCC_CR_HSITRIM_Msk >> RCC_CR_HSITRIM_Pos)))
+        {
+            trim++;
+        }
+        else
+        {
+            break;
+        }
+
+        RCC->CR = (RCC->CR & ~RCC_CR_HSITRIM) | (trim << RCC_CR_HSITRIM_Pos);
+    }
+
+    RCC->CR = (RCC->CR & ~RCC_CR_HSITRIM) | (best_trim << RCC_CR_HSITRIM_Pos);
+    rcc_clocks.hsi_hz = best_hz;
+    rccClockCacheUpdate();
+
+    if (ptr_hsi_hz != NULL)
+    {
+        *ptr_hsi_hz = best_hz;
+    }
+
+    return RCC_OK;
 }
 
 /**
- * @brief  This function returns current APB2 peripheral clock (PCLK2) frequency.
- * @return PCLK2 in Hz.
+ * @brief   This function routes an internal clock to an MCO pin.
+ * @details MCO1 outputs HSI, LSE, HSE or PLL on PA8; MCO2 outputs SYSCLK, PLLI2S,
+ *          HSE or PLL on PC9. The pin is switched to alternate function 0.
+ * @param   mco MCO output.
+ * @param   src Clock source.
+ * @param   div Output prescaler, 1 to 5.
+ * @return  RCC_OK on success, RCC_ERR_CFG for an invalid output, source or
+ *          prescaler.
  */
-uint32_t rccGetPCLK2(void)
+int rccMcoConfig(RCC_MCO mco, RCC_MCO_SRC src, uint32_t div)
+{
+    static const int8_t mco1_sel[] = { 0, 1, 2, 3, -1, -1 };
+    static const int8_t mco2_sel[] = { -1, -1, 2, 3, 0, 1 };
+    GPIO_CFG pin_cfg = {
+        .mode     = GPIO_MODE_ALT,
+        .otype    = GPIO_OTYPE_PP,
+        .speed    = GPIO_SPEED_HIGH,
+        .pupd     = GPIO_PUPD_NONE,
+        .alt_func = 0u
+    };
+
+    if ((mco > RCC_MCO_2) || (src > RCC_MCO_SRC_PLLI2S) || (div < 1u) || (div > 5u))
+    {
+        return RCC_ERR_CFG;
+    }
+
+    /* 0xx: no division, 100: /2 ... 111: /5 */
+    uint32_t pre = (div == 1u) ? 0u : (div + 2u);
+    int8_t sel = (mco == RCC_MCO_1) ? mco1_sel[src] : mco2_sel[src];
+
+    if (sel < 0)
+    {
+        return RCC_ERR_CFG;
+    }
+
+    if (mco == RCC_MCO_1)
+    {
+        RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_MCO1 | RCC_CFGR_MCO1PRE)) |
+                    ((uint32_t)sel << RCC_CFGR_MCO1_Pos) |
+                    (pre << RCC_CFGR_MCO1PRE_Pos);
+        pin_cfg.ptr_port = GPIOA;
+        pin_cfg.pin = PIN_8;
+    }
+    else
+    {
+        RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_MCO2 | RCC_CFGR_MCO2PRE)) |
+                    ((uint32_t)sel << RCC_CFGR_MCO2_Pos) |
+                    (pre << RCC_CFGR_MCO2PRE_Pos);
+        pin_cfg.ptr_port = GPIOC;
+        pin_cfg.pin = PIN_9;
+    }
+
+    gpioInit(&pin_cfg);
+
+    return RCC_OK;
+}
+
+/**
+ * @brief   This function stops an MCO output.
+ * @details The pin is returned to analog mode and the prescaler set to /5 to
+ *          minimise switching in the output path.
+ * @param   mco MCO output.
+ */
+void rccMcoDisable(RCC_MCO mco)
+{
+    GPIO_CFG pin_cfg = {
+        .ptr_port = (mco == RCC_MCO_1) ? GPIOA : GPIOC,
+        .pin      = (mco == RCC_MCO_1) ? PIN_8 : PIN_9,
+        .mode     = GPIO_MODE_ANALOG,
+        .otype    = GPIO_OTYPE_PP,
+        .speed    = GPIO_SPEED_LOW,
+        .pupd     = GPIO_PUPD_NONE,
+        .alt_func = 0u
+    };
+
+    gpioInit(&pin_cfg);
+
+    if (mco == RCC_MCO_1)
+    {
+        RCC->CFGR |= RCC_CFGR_MCO1PRE;
+    }
+    else
+    {
+        RCC->CFGR |= RCC_CFGR_MCO2PRE;
+    }
+}
+
+/**
+ * @brief   This function takes a reference on a peripheral clock.
+ * @details The clock is switched on when the first user enables it.
+ * @param   periph Peripheral ID.
+ * @return  RCC_OK on success, RCC_ERR_CFG for an invalid ID, RCC_ERR_REF on count overflow.
+ */
+int rccPeriphClockEnable(RCC_PERIPH periph)
+{
+    RCC_BUS bus = RCC_PERIPH_BUS(periph);
+    uint32_t pos = RCC_PERIPH_POS(periph);
+    int status = RCC_OK;
+
+    if (bus >= RCC_BUS_MAX)
+    {
+        return RCC_ERR_CFG;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (rcc_ref_count[bus][pos] == UINT8_MAX)
+    {
+        status = RCC_ERR_REF;
+    }
+    else if (rcc_ref_count[bus][pos]++ == 0u)
+    {
+        *rcc_enr_table[bus] |= (1UL << pos);
+
+        /* Read back so the clock is running before the first register access */
+        (void)*rcc_enr_table[bus];
+    }
+
+    __set_PRIMASK(primask);
+
+    return status;
+}
+
+/**
+ * @brief   This function releases a reference on a peripheral clock.
+ * @details The clock is gated when the last user releases it.
+ * @param   periph Peripheral ID.
+ * @return  RCC_OK on success, RCC_ERR_CFG for an invalid ID, RCC_ERR_REF if not referenced.
+ */
+int rccPeriphClockDisable(RCC_PERIPH periph)
 {
-    uint32_t pclk2 = rccGetHCLK();
+    RCC_BUS bus = RCC_PERIPH_BUS(periph);
+    uint32_t pos = RCC_PERIPH_POS(periph);
+    int status = RCC_OK;
 
-    if (((RCC->CFGR & RCC_CFGR_PPRE2) >> 13) != 0)
+    if (bus >= RCC_BUS_MAX)
     {
-        pclk2 = pclk2 >> (((RCC->CFGR & RCC_CFGR_PPRE2) >> 13) - 1);
+        return RCC_ERR_CFG;
     }
 
-    return pclk2;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (rcc_ref_count[bus][pos] == 0u)
+    {
+        status = RCC_ERR_REF;
+    }
+    else if (--rcc_ref_count[bus][pos] == 0u)
+    {
+        *rcc_enr_table[bus] &= ~(1UL << pos);
+    }
+
+    __set_PRIMASK(primask);
+
+    return status;
+}
+
+/**
+ * @brief This function selects whether a peripheral stays clocked in Sleep mode.
+ * @param periph Peripheral ID.
+ * @param enable 1 to keep the clock running in Sleep mode, 0 to gate it.
+ */
+void rccPeriphClockLowPower(RCC_PERIPH periph, uint8_t enable)
+{
+    RCC_BUS bus = RCC_PERIPH_BUS(periph);
+    uint32_t mask = 1UL << RCC_PERIPH_POS(periph);
+
+    if (bus >= RCC_BUS_MAX)
+    {
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (enable != 0u)
+    {
+        *rcc_lpenr_table[bus] |= mask;
+    }
+    else
+    {
+        *rcc_lpenr_table[bus] &= ~mask;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief This function pulses the reset line of a peripheral.
+ * @param periph Peripheral ID.
+ */
+void rccPeriphReset(RCC_PERIPH periph)
+{
+    RCC_BUS bus = RCC_PERIPH_BUS(periph);
+    uint32_t mask = 1UL << RCC_PERIPH_POS(periph);
+
+    if (bus >= RCC_BUS_MAX)
+    {
+        return;
+    }
+
+    /* Both writes are read-modify-write on a register shared by the bus */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    *rcc_rstr_table[bus] |= mask;
+    *rcc_rstr_table[bus] &= ~mask;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  This function checks whether a peripheral clock is currently enabled.
+ * @param  periph Peripheral ID.
+ * @return 1 if clocked, otherwise 0.
+ */
+uint8_t rccPeriphIsClocked(RCC_PERIPH periph)
+{
+    RCC_BUS bus = RCC_PERIPH_BUS(periph);
+
+    if (bus >= RCC_BUS_MAX)
+    {
+        return 0u;
+    }
+
+    return (uint8_t)((*rcc_enr_table[bus] >> RCC_PERIPH_POS(periph)) & 1UL);
+}
+
+/**
+ * @brief  This function returns the number of users holding a peripheral clock.
+ * @param  periph Peripheral ID.
+ * @return Reference count.
+ */
+uint8_t rccPeriphGetRefCount(RCC_PERIPH periph)
+{
+    RCC_BUS bus = RCC_PERIPH_BUS(periph);
+
+    if (bus >= RCC_BUS_MAX)
+    {
+        return 0u;
+    }
+
+    return rcc_ref_count[bus][RCC_PERIPH_POS(periph)];
+}
+
+/**
+ * @brief  This function returns the enable register of a bus.
+ * @param  bus Bus to query.
+ * @return Bitmask of clocked peripherals on the bus.
+ */
+uint32_t rccGetClockedMask(RCC_BUS bus)
+{
+    if (bus >= RCC_BUS_MAX)
+    {
+        return 0u;
+    }
+
+    return *rcc_enr_table[bus];
 }
 
 /**
@@ -317,12 +982,54 @@ uint32_t rccGetPCLK2(void)
  */
 static int waitForFlag(volatile uint32_t *ptr_reg, uint32_t flag)
 {
-    uint32_t timeout = TIMEOUT;
+    return (timeoutWaitSet(ptr_reg, flag, TIMEOUT_US) == TIMEOUT_OK) ? RCC_OK : -1;
+}
+
+/**
+ * @brief  This function measures an input frequency from consecutive captures.
+ * @param  ptr_tim Timer running the capture.
+ * @param  ptr_ccr Capture register to read.
+ * @param  flag Capture flag in SR.
+ * @param  mask Counter width mask.
+ * @param  tim_hz Timer kernel clock in Hz.
+ * @param  ptr_hz Pointer to store the input frequency in Hz.
+ * @return RCC_OK on success, RCC_ERR_OSC if no edge was captured.
+ */
+static int rccCaptureFrequency(TIM_TypeDef *ptr_tim, volatile uint32_t *ptr_ccr, uint32_t flag,
+                               uint32_t mask, uint32_t tim_hz, uint32_t *ptr_hz)
+{
+    uint64_t total = 0u;
+    uint32_t last;
+
+    ptr_tim->SR = 0u;
+    ptr_tim->CR1 = TIM_CR1_CEN;
+
+    /* First capture only provides the reference edge */
+    if (waitForFlag(&ptr_tim->SR, flag) != 0)
+    {
+        return RCC_ERR_OSC;
+    }
+    last = *ptr_ccr;
+
+    for (uint32_t i = 0u; i < RCC_MEAS_CAPTURES; i++)
+    {
+        if (waitForFlag(&ptr_tim->SR, flag) != 0)
+        {
+            return RCC_ERR_OSC;
+        }
+
+        uint32_t now = *ptr_ccr;
+        total += (now - last) & mask;
+        last = now;
+    }
 
-    while (((*ptr_reg & flag) == 0) && (timeout-- > 0))
+    if (total == 0u)
     {
-        __NOP();
+        return RCC_ERR_OSC;
     }
 
-    return ((*ptr_reg & flag) != 0) ? RCC_OK : -1;
-}
\ No newline at end of file
+    /* Each capture spans 8 input periods (IC prescaler /8) */
+    *ptr_hz = (uint32_t)(((uint64_t)tim_hz * 8u * RCC_MEAS_CAPTURES + (total / 2u)) / total);
+
+    return RCC_OK;
+}
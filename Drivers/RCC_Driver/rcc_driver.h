@@ -10,16 +10,156 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "stm32f446xx.h"
+#include "clock_profile.h"
+
+/**
+ * @section Public Macro Definations.
+ */
+#define RCC_OK        0
+#define RCC_ERR_CFG  -1
+#define RCC_ERR_HSE  -2
+#define RCC_ERR_PLL  -3
+#define RCC_ERR_HSI  -4
+#define RCC_ERR_SYS  -5
+#define RCC_ERR_REF  -6
+#define RCC_ERR_OSC  -7
+#define RCC_ERR_BUSY -8
+
+#define RCC_LSI_HZ          32000UL
+#define RCC_LSE_HZ          32768UL
+#define RCC_MEAS_CAPTURES   16U
+#define RCC_CLOCK_CB_MAX    4U
+
+/**
+ * @brief Peripheral ID encoding: bus index in bits [7:5], enable bit position in bits [4:0].
+ */
+#define RCC_PERIPH_ID(bus, pos)   ((((uint32_t)(bus)) << 5) | ((uint32_t)(pos) & 0x1FU))
+#define RCC_PERIPH_BUS(id)        ((RCC_BUS)(((uint32_t)(id)) >> 5))
+#define RCC_PERIPH_POS(id)        (((uint32_t)(id)) & 0x1FU)
 
 /**
 * @section  Public Type Declaration
 */
+typedef enum {
+    RCC_BUS_AHB1 = 0,
+    RCC_BUS_AHB2,
+    RCC_BUS_AHB3,
+    RCC_BUS_APB1,
+    RCC_BUS_APB2,
+    RCC_BUS_MAX
+} RCC_BUS;
+
+typedef enum {
+    /* AHB1 */
+    RCC_PERIPH_GPIOA     = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_GPIOAEN_Pos),
+    RCC_PERIPH_GPIOB     = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_GPIOBEN_Pos),
+    RCC_PERIPH_GPIOC     = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_GPIOCEN_Pos),
+    RCC_PERIPH_GPIOD     = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_GPIODEN_Pos),
+    RCC_PERIPH_GPIOE     = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_GPIOEEN_Pos),
+    RCC_PERIPH_GPIOF     = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_GPIOFEN_Pos),
+    RCC_PERIPH_GPIOG     = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_GPIOGEN_Pos),
+    RCC_PERIPH_GPIOH     = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_GPIOHEN_Pos),
+    RCC_PERIPH_CRC       = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_CRCEN_Pos),
+    RCC_PERIPH_BKPSRAM   = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_BKPSRAMEN_Pos),
+    RCC_PERIPH_DMA1      = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_DMA1EN_Pos),
+    RCC_PERIPH_DMA2      = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_DMA2EN_Pos),
+    RCC_PERIPH_OTGHS     = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_OTGHSEN_Pos),
+    RCC_PERIPH_OTGHSULPI = RCC_PERIPH_ID(RCC_BUS_AHB1, RCC_AHB1ENR_OTGHSULPIEN_Pos),
+
+    /* AHB2 */
+    RCC_PERIPH_DCMI      = RCC_PERIPH_ID(RCC_BUS_AHB2, RCC_AHB2ENR_DCMIEN_Pos),
+    RCC_PERIPH_OTGFS     = RCC_PERIPH_ID(RCC_BUS_AHB2, RCC_AHB2ENR_OTGFSEN_Pos),
+
+    /* AHB3 */
+    RCC_PERIPH_FMC       = RCC_PERIPH_ID(RCC_BUS_AHB3, RCC_AHB3ENR_FMCEN_Pos),
+    RCC_PERIPH_QSPI      = RCC_PERIPH_ID(RCC_BUS_AHB3, RCC_AHB3ENR_QSPIEN_Pos),
+
+    /* APB1 */
+    RCC_PERIPH_TIM2      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_TIM2EN_Pos),
+    RCC_PERIPH_TIM3      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_TIM3EN_Pos),
+    RCC_PERIPH_TIM4      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_TIM4EN_Pos),
+    RCC_PERIPH_TIM5      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_TIM5EN_Pos),
+    RCC_PERIPH_TIM6      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_TIM6EN_Pos),
+    RCC_PERIPH_TIM7      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_TIM7EN_Pos),
+    RCC_PERIPH_TIM12     = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_TIM12EN_Pos),
+    RCC_PERIPH_TIM13     = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_TIM13EN_Pos),
+    RCC_PERIPH_TIM14     = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_TIM14EN_Pos),
+    RCC_PERIPH_WWDG      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_WWDGEN_Pos),
+    RCC_PERIPH_SPI2      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_SPI2EN_Pos),
+    RCC_PERIPH_SPI3      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_SPI3EN_Pos),
+    RCC_PERIPH_SPDIFRX   = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_SPDIFRXEN_Pos),
+    RCC_PERIPH_USART2    = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_USART2EN_Pos),
+    RCC_PERIPH_USART3    = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_USART3EN_Pos),
+    RCC_PERIPH_UART4     = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_UART4EN_Pos),
+    RCC_PERIPH_UART5     = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_UART5EN_Pos),
+    RCC_PERIPH_I2C1      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_I2C1EN_Pos),
+    RCC_PERIPH_I2C2      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_I2C2EN_Pos),
+    RCC_PERIPH_I2C3      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_I2C3EN_Pos),
+    RCC_PERIPH_FMPI2C1   = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_FMPI2C1EN_Pos),
+    RCC_PERIPH_CAN1      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_CAN1EN_Pos),
+    RCC_PERIPH_CAN2      = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_CAN2EN_Pos),
+    RCC_PERIPH_CEC       = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_CECEN_Pos),
+    RCC_PERIPH_PWR       = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_PWREN_Pos),
+    RCC_PERIPH_DAC       = RCC_PERIPH_ID(RCC_BUS_APB1, RCC_APB1ENR_DACEN_Pos),
+
+    /* APB2 */
+    RCC_PERIPH_TIM1      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_TIM1EN_Pos),
+    RCC_PERIPH_TIM8      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_TIM8EN_Pos),
+    RCC_PERIPH_USART1    = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_USART1EN_Pos),
+    RCC_PERIPH_USART6    = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_USART6EN_Pos),
+    RCC_PERIPH_ADC1      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_ADC1EN_Pos),
+    RCC_PERIPH_ADC2      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_ADC2EN_Pos),
+    RCC_PERIPH_ADC3      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_ADC3EN_Pos),
+    RCC_PERIPH_SDIO      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_SDIOEN_Pos),
+    RCC_PERIPH_SPI1      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_SPI1EN_Pos),
+    RCC_PERIPH_SPI4      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_SPI4EN_Pos),
+    RCC_PERIPH_SYSCFG    = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_SYSCFGEN_Pos),
+    RCC_PERIPH_TIM9      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_TIM9EN_Pos),
+    RCC_PERIPH_TIM10     = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_TIM10EN_Pos),
+    RCC_PERIPH_TIM11     = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_TIM11EN_Pos),
+    RCC_PERIPH_SAI1      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_SAI1EN_Pos),
+    RCC_PERIPH_SAI2      = RCC_PERIPH_ID(RCC_BUS_APB2, RCC_APB2ENR_SAI2EN_Pos)
+} RCC_PERIPH;
+
 typedef enum {
     RCC_CLK_SRC_HSI = 0,
     RCC_CLK_SRC_HSE,
     RCC_CLK_SRC_PLL
 } RCC_CLK_SRC;
 
+typedef enum {
+    RCC_MEAS_LSI = 0,
+    RCC_MEAS_LSE,
+    RCC_MEAS_HSE
+} RCC_MEAS_SRC;
+
+typedef enum {
+    RCC_MCO_1 = 0,      /* PA8 */
+    RCC_MCO_2           /* PC9 */
+} RCC_MCO;
+
+typedef enum {
+    RCC_MCO_SRC_HSI = 0,    /* MCO1 only */
+    RCC_MCO_SRC_LSE,        /* MCO1 only */
+    RCC_MCO_SRC_HSE,
+    RCC_MCO_SRC_PLL,
+    RCC_MCO_SRC_SYSCLK,     /* MCO2 only */
+    RCC_MCO_SRC_PLLI2S      /* MCO2 only */
+} RCC_MCO_SRC;
+
+typedef struct {
+    uint32_t hsi_hz;
+    uint32_t hse_hz;
+    uint32_t lsi_hz;
+    uint32_t lse_hz;
+    uint32_t sysclk_hz;
+    uint32_t hclk_hz;
+    uint32_t pclk1_hz;
+    uint32_t pclk2_hz;
+    uint32_t timclk1_hz;
+    uint32_t timclk2_hz;
+} RCC_CLOCKS;
+
 typedef struct {
     uint32_t SRC;
     uint32_t M;
@@ -37,12 +177,22 @@ typedef struct {
     uint32_t FLASH_LATENCY;
 } RCC_SYS_CFG;
 
+/**
+ * @brief Callback function pointer for clock tree change notification.
+ */
+typedef void (*fp_rcc_clock_callback)(void);
+
 /**
  * @section Public Functions Declaration
  */
 int rccSystemClockConfig(const RCC_SYS_CFG *ptr_config);
+int rccApplyClockProfile(void);
 void rccEnableAHB1(uint32_t mask);
 void rccDisableAHB1(uint32_t mask);
+void rccEnableAHB2(uint32_t mask);
+void rccDisableAHB2(uint32_t mask);
+void rccEnableAHB3(uint32_t mask);
+void rccDisableAHB3(uint32_t mask);
 void rccEnableAPB1(uint32_t mask);
 void rccDisableAPB1(uint32_t mask);
 void rccResetAPB1(uint32_t mask);
@@ -53,5 +203,21 @@ uint32_t rccGetSYSCLK(void);
 uint32_t rccGetHCLK(void);
 uint32_t rccGetPCLK1(void);
 uint32_t rccGetPCLK2(void);
+uint32_t rccGetTIMCLK1(void);
+uint32_t rccGetTIMCLK2(void);
+void rccGetClocks(RCC_CLOCKS *ptr_clocks);
+void rccClockCacheUpdate(void);
+int rccRegisterClockCallback(fp_rcc_clock_callback ptr_callback);
+int rccMeasureClock(RCC_MEAS_SRC src, uint32_t *ptr_hz);
+int rccCalibrateHSI(uint32_t *ptr_hsi_hz);
+int rccMcoConfig(RCC_MCO mco, RCC_MCO_SRC src, uint32_t div);
+void rccMcoDisable(RCC_MCO mco);
+int rccPeriphClockEnable(RCC_PERIPH periph);
+int rccPeriphClockDisable(RCC_PERIPH periph);
+void rccPeriphClockLowPower(RCC_PERIPH periph, uint8_t enable);
+void rccPeriphReset(RCC_PERIPH periph);
+uint8_t rccPeriphIsClocked(RCC_PERIPH periph);
+uint8_t rccPeriphGetRefCount(RCC_PERIPH periph);
+uint32_t rccGetClockedMask(RCC_BUS bus);
 
 #endif
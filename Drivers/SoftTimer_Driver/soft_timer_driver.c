@@ -0,0 +1,442 @@
+/**
+ * @file    soft_timer_driver.c
+ * @author  Pratik Dhulubulu
+ * @brief   This file implements a hierarchical software timer wheel with
+ *          O(1) insert/cancel and deferred callback execution in a
+ *          software-triggered interrupt.
+ */
+
+#include "soft_timer_driver.h"
+#include "systick_driver.h"
+
+/**
+ * @section Private Macro Definations.
+ */
+#define SLOT_MASK       (SOFT_TIMER_SLOTS - 1U)
+#define WHEEL_SPAN      (1UL << (SOFT_TIMER_LEVELS * SOFT_TIMER_SLOT_BITS))
+
+/**
+ * @section Private Data Definations.
+ */
+
+/* Each slot is a circular list whose head is a sentinel node */
+static SOFT_TIMER wheel[SOFT_TIMER_LEVELS][SOFT_TIMER_SLOTS];
+static uint32_t wheel_now = 0u;
+static volatile uint32_t active_count = 0u;
+
+/**
+ * @section Private Function Declarations.
+ */
+static void listInit(SOFT_TIMER *ptr_head);
+static void listAppend(SOFT_TIMER *ptr_head, SOFT_TIMER *ptr_node);
+static void listRemove(SOFT_TIMER *ptr_node);
+static void listMove(SOFT_TIMER *ptr_dst, SOFT_TIMER *ptr_src);
+static void wheelInsert(SOFT_TIMER *ptr_timer);
+static void wheelCascade(uint32_t level, uint32_t slot);
+static void wheelRunTick(uint32_t now);
+
+/**
+ * @section Public Function Definations.
+ */
+
+/**
+ * @brief  This function initializes the timer wheel.
+ * @param  irq_priority NVIC priority of SOFT_TIMER_IRQn, normally the lowest.
+ * @return None.
+ */
+void softTimerInit(uint8_t irq_priority)
+{
+    for (uint32_t level = 0u; level < SOFT_TIMER_LEVELS; level++)
+    {
+        for (uint32_t slot = 0u; slot < SOFT_TIMER_SLOTS; slot++)
+        {
+            listInit(&wheel[level][slot]);
+        }
+    }
+
+    wheel_now = sysTickGetTick();
+    active_count = 0u;
+
+    NVIC_ClearPendingIRQ(SOFT_TIMER_IRQn);
+    NVIC_SetPriority(SOFT_TIMER_IRQn, irq_priority);
+    NVIC_EnableIRQ(SOFT_TIMER_IRQn);
+}
+
+/**
+ * @brief  This function prepares a timer node before first use.
+ * @param  ptr_timer Pointer to caller-owned timer.
+ * @param  callback Function called on expiry.
+ * @param  ptr_ctx Context passed to the callback.
+ * @return None.
+ */
+void softTimerSetup(SOFT_TIMER *ptr_timer, fp_soft_timer_callback callback, void *ptr_ctx)
+{
+    if (ptr_timer == NULL)
+    {
+        return;
+    }
+
+    ptr_timer->ptr_next = NULL;
+    ptr_timer->ptr_prev = NULL;
+    ptr_timer->expires  = 0u;
+    ptr_timer->period   = 0u;
+    ptr_timer->callback = callback;
+    ptr_timer->ptr_ctx  = ptr_ctx;
+}
+
+/**
+ * @brief   This function arms a timer, restarting it if already active.
+ * @details Safe to call from thread, ISR and callback context. Delays and
+ *          periods are limited to SOFT_TIMER_MAX_TICKS so expiries stay
+ *          comparable across the 32-bit tick wrap.
+ * @param   ptr_timer Pointer to timer.
+ * @param   delay_ticks Ticks until first expiry, at least 1.
+ * @param   period_ticks Reload period in ticks, 0 for one-shot.
+ * @return  SOFT_TIMER_OK on success, SOFT_TIMER_ERR_CFG on invalid arguments.
+ */
+int softTimerStart(SOFT_TIMER *ptr_timer, uint32_t delay_ticks, uint32_t period_ticks)
+{
+    if ((ptr_timer == NULL) || (ptr_timer->callback == NULL) ||
+        (delay_ticks > SOFT_TIMER_MAX_TICKS) || (period_ticks > SOFT_TIMER_MAX_TICKS))
+    {
+        return SOFT_TIMER_ERR_CFG;
+    }
+
+    if (delay_ticks == 0u)
+    {
+        delay_ticks = 1u;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (ptr_timer->ptr_next != NULL)
+    {
+        listRemove(ptr_timer);
+        active_count--;
+    }
+
+    uint32_t now = sysTickGetTick();
+
+    if (active_count == 0u)
+    {
+        /* Nothing was armed so the wheel was not clocked, bring it up to date */
+        wheel_now = now;
+    }
+
+    /* Expiry is relative to the real tick, the wheel may lag behind it */
+    ptr_timer->expires = now + delay_ticks;
+    ptr_timer->period = period_ticks;
+    wheelInsert(ptr_timer);
+    active_count++;
+
+    __set_PRIMASK(primask);
+
+    return SOFT_TIMER_OK;
+}
+
+/**
+ * @brief  This function stops a timer. Cancelling an idle timer is a no-op.
+ * @param  ptr_timer Pointer to timer.
+ * @return None.
+ */
+void softTimerCancel(SOFT_TIMER *ptr_timer)
+{
+    if (ptr_timer == NULL)
+    {
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (ptr_timer->ptr_next != NULL)
+    {
+        listRemove(ptr_timer);
+        active_count--;
+    }
+    ptr_timer->period = 0u;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  This function checks whether a timer is armed.
+ * @param  ptr_timer Pointer to timer.
+ * @return 1 if armed, otherwise 0.
+ */
+uint8_t softTimerIsActive(const SOFT_TIMER *ptr_timer)
+{
+    return (uint8_t)((ptr_timer != NULL) && (ptr_timer->ptr_next != NULL));
+}
+
+/**
+ * @brief   This function returns a lower bound of ticks until the next expiry.
+ * @details Only the first wheel level is scanned; beyond it the next cascade
+ *          point is returned. Intended for sysTickIdle().
+ * @return  Ticks until the wheel needs service, UINT32_MAX if no timer is active.
+ */
+uint32_t softTimerTicksToNext(void)
+{
+    uint32_t ticks = UINT32_MAX;
+
+    if (active_count == 0u)
+    {
+        return ticks;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t now = sysTickGetTick();
+    uint32_t lag = now - wheel_now;
+
+    if (lag != 0u)
+    {
+        /* Processing is already pending */
+        ticks = 0u;
+    }
+    else
+    {
+        ticks = SOFT_TIMER_SLOTS - (now & SLOT_MASK);
+
+        for (uint32_t i = 1u; i < ticks; i++)
+        {
+            SOFT_TIMER *ptr_head = &wheel[0][(now + i) & SLOT_MASK];
+
+            if (ptr_head->ptr_next != ptr_head)
+            {
+                ticks = i;
+                break;
+            }
+        }
+    }
+
+    __set_PRIMASK(primask);
+
+    return ticks;
+}
+
+/**
+ * @brief  This function is called from the SysTick ISR and defers work to SOFT_TIMER_IRQn.
+ * @return None.
+ */
+void softTimerHandleTick(void)
+{
+    if (active_count != 0u)
+    {
+        NVIC_SetPendingIRQ(SOFT_TIMER_IRQn);
+    }
+}
+
+/**
+ * @brief   This function advances the wheel to the current tick.
+ * @details Called from SOFT_TIMER_IRQn. Several ticks are processed after a
+ *          tickless idle. A callback restarting the only timer may move
+ *          wheel_now past now, which ends the loop.
+ * @return  None.
+ */
+void softTimerHandleIrq(void)
+{
+    uint32_t now = sysTickGetTick();
+
+    while ((int32_t)(now - wheel_now) > 0)
+    {
+        wheel_now++;
+        wheelRunTick(wheel_now);
+    }
+}
+
+/**
+ * @section Private Function Definations.
+ */
+
+/**
+ * @brief  This function initializes an empty list head.
+ * @param  ptr_head Sentinel node.
+ * @return None.
+ */
+static void listInit(SOFT_TIMER *ptr_head)
+{
+    ptr_head->ptr_next = ptr_head;
+    ptr_head->ptr_prev = ptr_head;
+}
+
+/**
+ * @brief  This function appends a node to a list.
+ * @param  ptr_head Sentinel node.
+ * @param  ptr_node Node to append.
+ * @return None.
+ */
+static void listAppend(SOFT_TIMER *ptr_head, SOFT_TIMER *ptr_node)
+{
+    ptr_node->ptr_next = ptr_head;
+    ptr_node->ptr_prev = ptr_head->ptr_prev;
+    ptr_head->ptr_prev->ptr_next = ptr_node;
+    ptr_head->ptr_prev = ptr_node;
+}
+
+/**
+ * @brief  This function unlinks a node and marks it idle.
+ * @param  ptr_node Node to remove.
+ * @return None.
+ */
+static void listRemove(SOFT_TIMER *ptr_node)
+{
+    ptr_node->ptr_prev->ptr_next = ptr_node->ptr_next;
+    ptr_node->ptr_next->ptr_prev = ptr_node->ptr_prev;
+    ptr_node->ptr_next = NULL;
+    ptr_node->ptr_prev = NULL;
+}
+
+/**
+ * @brief  This function moves all nodes of a list to an empty list.
+ * @param  ptr_dst Destination sentinel, must be empty.
+ * @param  ptr_src Source sentinel, left empty.
+ * @return None.
+ */
+static void listMove(SOFT_TIMER *ptr_dst, SOFT_TIMER *ptr_src)
+{
+    if (ptr_src->ptr_next == ptr_src)
+    {
+        listInit(ptr_dst);
+        return;
+    }
+
+    ptr_dst->ptr_next = ptr_src->ptr_next;
+    ptr_dst->ptr_prev = ptr_src->ptr_prev;
+    ptr_dst->ptr_next->ptr_prev = ptr_dst;
+    ptr_dst->ptr_prev->ptr_next = ptr_dst;
+    listInit(ptr_src);
+}
+
+/**
+ * @brief   This function places a timer in the slot matching its expiry.
+ * @details Must be called with interrupts disabled. Expiries past the wheel span
+ *          are parked in the last top-level slot and re-sorted on cascade.
+ *          An expiry equal to wheel_now only comes from a cascade, which runs
+ *          before the level 0 slot of that tick is drained, so it goes to that
+ *          slot and still fires on time.
+ * @param   ptr_timer Timer to insert.
+ * @return  None.
+ */
+static void wheelInsert(SOFT_TIMER *ptr_timer)
+{
+    uint32_t expires = ptr_timer->expires;
+    int32_t delta = (int32_t)(expires - wheel_now);
+    uint32_t level = 0u;
+
+    if (delta < 0)
+    {
+        /* Overdue, run on the next processed tick */
+        expires = wheel_now + 1u;
+        delta = 1;
+    }
+    else if ((uint32_t)delta >= WHEEL_SPAN)
+    {
+        expires = wheel_now + (WHEEL_SPAN - 1u);
+        delta = (int32_t)(WHEEL_SPAN - 1u);
+    }
+
+    while ((level < (SOFT_TIMER_LEVELS - 1u)) &&
+           ((uint32_t)delta >= (1UL << ((level + 1u) * SOFT_TIMER_SLOT_BITS))))
+    {
+        level++;
+    }
+
+    uint32_t slot = (expires >> (level * SOFT_TIMER_SLOT_BITS)) & SLOT_MASK;
+    listAppend(&wheel[level][slot], ptr_timer);
+}
+
+/**
+ * @brief  This function re-sorts a higher-level slot into lower levels.
+ * @param  level Wheel level.
+ * @param  slot Slot index.
+ * @return None.
+ */
+static void wheelCascade(uint32_t level, uint32_t slot)
+{
+    SOFT_TIMER pending;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    listMove(&pending, &wheel[level][slot]);
+
+    while (pending.ptr_next != &pending)
+    {
+        SOFT_TIMER *ptr_timer = pending.ptr_next;
+        listRemove(ptr_timer);
+        wheelInsert(ptr_timer);
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   This function processes a single wheel tick.
+ * @details Expired timers are moved to a local list; each is then popped under
+ *          a short critical section and its callback runs with interrupts
+ *          enabled, so callbacks may start or cancel any timer.
+ * @param   now Tick being processed.
+ * @return  None.
+ */
+static void wheelRunTick(uint32_t now)
+{
+    SOFT_TIMER expired;
+
+    for (uint32_t level = 1u; level < SOFT_TIMER_LEVELS; level++)
+    {
+        if ((now & ((1UL << (level * SOFT_TIMER_SLOT_BITS)) - 1u)) != 0u)
+        {
+            break;
+        }
+        wheelCascade(level, (now >> (level * SOFT_TIMER_SLOT_BITS)) & SLOT_MASK);
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    listMove(&expired, &wheel[0][now & SLOT_MASK]);
+    __set_PRIMASK(primask);
+
+    for (;;)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+
+        SOFT_TIMER *ptr_timer = expired.ptr_next;
+        if (ptr_timer == &expired)
+        {
+            __set_PRIMASK(primask);
+            break;
+        }
+
+        listRemove(ptr_timer);
+
+        if ((int32_t)(ptr_timer->expires - now) > 0)
+        {
+            /* Parked beyond the wheel span, not due yet */
+            wheelInsert(ptr_timer);
+            __set_PRIMASK(primask);
+            continue;
+        }
+
+        /* Periodic timers are re-armed before the callback so it may cancel them */
+        if (ptr_timer->period != 0u)
+        {
+            ptr_timer->expires += ptr_timer->period;
+            wheelInsert(ptr_timer);
+        }
+        else
+        {
+            active_count--;
+        }
+
+        fp_soft_timer_callback callback = ptr_timer->callback;
+        void *ptr_ctx = ptr_timer->ptr_ctx;
+
+        __set_PRIMASK(primask);
+
+        callback(ptr_ctx);
+    }
+}
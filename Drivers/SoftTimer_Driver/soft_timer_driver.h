@@ -0,0 +1,62 @@
+/**
+ * @file    soft_timer_driver.h
+ * @author  Pratik Dhulubulu
+ * @brief   Software Timer Wheel Interface.
+ * @details Hierarchical timer wheel clocked by SysTick. Timers are caller-owned
+ *          nodes, so any number can be active without heap allocation. Insert
+ *          and cancel are O(1); callbacks run from a software-triggered
+ *          interrupt, not from SysTick. PendSV is left to the RTOS port.
+ */
+
+#ifndef SOFT_TIMER_DRIVER_H
+#define SOFT_TIMER_DRIVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "stm32f446xx.h"
+
+/**
+ * @section Public Macro Definations.
+ */
+#define SOFT_TIMER_OK         0
+#define SOFT_TIMER_ERR_CFG   -1
+
+#define SOFT_TIMER_LEVELS     4U
+#define SOFT_TIMER_SLOT_BITS  6U
+#define SOFT_TIMER_SLOTS      (1U << SOFT_TIMER_SLOT_BITS)
+#define SOFT_TIMER_MAX_TICKS  0x7FFFFFFFUL
+
+/* Vector 80 is reserved on the STM32F446, no peripheral can raise it */
+#define SOFT_TIMER_IRQn       ((IRQn_Type)80)
+
+/**
+ * @section Public Type Declarations.
+ */
+
+/**
+ * @brief Callback function pointer for timer expiry, runs in SOFT_TIMER_IRQn context.
+ */
+typedef void (*fp_soft_timer_callback)(void *ptr_ctx);
+
+typedef struct SOFT_TIMER {
+    struct SOFT_TIMER      *ptr_next;   /* NULL while the timer is idle */
+    struct SOFT_TIMER      *ptr_prev;
+    uint32_t               expires;     /* Absolute expiry tick */
+    uint32_t               period;      /* 0 for one-shot */
+    fp_soft_timer_callback callback;
+    void                   *ptr_ctx;
+} SOFT_TIMER;
+
+/**
+ * @section Public Function Declarations.
+ */
+void softTimerInit(uint8_t irq_priority);
+void softTimerSetup(SOFT_TIMER *ptr_timer, fp_soft_timer_callback callback, void *ptr_ctx);
+int softTimerStart(SOFT_TIMER *ptr_timer, uint32_t delay_ticks, uint32_t period_ticks);
+void softTimerCancel(SOFT_TIMER *ptr_timer);
+uint8_t softTimerIsActive(const SOFT_TIMER *ptr_timer);
+uint32_t softTimerTicksToNext(void);
+void softTimerHandleTick(void);
+void softTimerHandleIrq(void);
+
+#endif
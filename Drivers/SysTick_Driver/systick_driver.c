@@ -2,17 +2,42 @@
  * @file    systick_driver.c
  * @author  Pratik Dhulubulu
  * @brief   This file provides SysTick initialization, millisecond delay,
- *          and tick retrieval functions. 
+ *          tick retrieval and a 64-bit monotonic time base. 
  */
  
 #include "systick_driver.h"
 #include "stm32f446xx.h"
+#include "rcc_driver.h"
+
+/**
+ * @section Private Macro Definations.
+ */
+#define SYSTICK_RESUME_MARGIN   16U
 
 /** 
  * @section Public Data Definations.
  */
 volatile uint32_t tick = 0u;
 
+/** 
+ * @section Private Data Definations.
+ */
+static volatile uint64_t tick_slot[2] = {0u, 0u};
+static volatile uint32_t tick_seq = 0u;
+static uint32_t systick_clk_hz = 0u;
+static uint32_t systick_cycles_per_tick = 0u;
+static uint32_t systick_rate_hz = 0u;
+
+/** 
+ * @section Private Function Declarations.
+ */
+static uint64_t sysTickReadTick64(void);
+static void sysTickAdvance(uint32_t ticks);
+static uint32_t sysTickResume(uint32_t next, uint32_t stopped_at);
+static void sysTickCycleCounterOn(void);
+static int sysTickProgram(uint32_t rate_hz);
+static void sysTickClockChanged(void);
+
 /** 
  * @section Public Function Definations.
  */
@@ -20,15 +45,51 @@ volatile uint32_t tick = 0u;
 /** 
  * @brief This function initialize SysTick.
  * @param tick Number of SysTick counts for 1 timer period.
- * @return None.
+ * @return SYSTICK_OK on success, SYSTICK_ERR_CFG if ticks does not fit in LOAD.
  */
-void sysTickInit(uint32_t ticks)
+int sysTickInit(uint32_t ticks)
 {
+    if ((ticks < 2u) || ((ticks - 1u) > SysTick_LOAD_RELOAD_Msk))
+    {
+        return SYSTICK_ERR_CFG;
+    }
+
+    systick_clk_hz = SystemCoreClock;
+    systick_cycles_per_tick = ticks;
+    systick_rate_hz = 0u;
+
     SysTick->LOAD = ticks - 1u;
     SysTick->VAL  = 0u;
     SysTick->CTRL = SysTick_CTRL_TICKINT_Msk |
                     SysTick_CTRL_ENABLE_Msk |
                     SysTick_CTRL_CLKSOURCE_Msk;
+
+    return SYSTICK_OK;
+}
+
+/**
+ * @brief   This function initializes SysTick for a tick rate.
+ * @details The reload is derived from the cached HCLK. If it does not fit in
+ *          the 24-bit LOAD register the HCLK/8 source is used instead. The
+ *          reload is re-derived automatically when the RCC driver changes
+ *          the clock tree.
+ * @param   rate_hz Tick rate in Hz.
+ * @param   priority NVIC priority of the SysTick exception.
+ * @return  SYSTICK_OK on success, SYSTICK_ERR_CFG if the rate cannot be reached.
+ */
+int sysTickInitHz(uint32_t rate_hz, uint8_t priority)
+{
+    int status = sysTickProgram(rate_hz);
+
+    if (status != SYSTICK_OK)
+    {
+        return status;
+    }
+
+    NVIC_SetPriority(SysTick_IRQn, priority);
+    (void)rccRegisterClockCallback(sysTickClockChanged);
+
+    return SYSTICK_OK;
 }
 
 /**
@@ -45,6 +106,22 @@ void sysTickDelayMs(uint32_t ms)
     }
 }
 
+/**
+ * @brief   This function sleeps for specified milliseconds.
+ * @details The core waits in WFI between ticks instead of spinning, any
+ *          other interrupt only causes an early re-check.
+ * @param   ms Number of milliseconds to sleep.
+ * @return  None
+ */
+void sysTickSleepMs(uint32_t ms)
+{
+    uint32_t m = tick;
+    while (tick-m < ms)
+    {
+        __WFI();
+    }
+}
+
 /**
  * @brief This function returns the current SysTick tick count.
  * @return tick Current tick count
@@ -53,3 +130,364 @@ uint32_t sysTickGetTick(void)
 {
     return tick;
 }
+
+/**
+ * @brief  This function returns the 64-bit tick count.
+ * @return Number of SysTick periods since sysTickInit().
+ */
+uint64_t sysTickGetTick64(void)
+{
+    return sysTickReadTick64();
+}
+
+/**
+ * @brief   This function returns the monotonic time in microseconds.
+ * @details The tick count is combined with the elapsed part of the current
+ *          period from SysTick->VAL. A reload that has not been counted yet
+ *          (ISR pending or masked) is detected through the VAL reload and
+ *          PENDSTSET, so the result never goes backwards.
+ * @return  Microseconds since sysTickInit().
+ */
+uint64_t sysTickGetUs64(void)
+{
+    uint64_t ticks;
+    uint32_t val_1;
+    uint32_t val_2;
+    uint32_t pending;
+    uint32_t load = SysTick->LOAD;
+
+    if (systick_clk_hz == 0u)
+    {
+        return 0u;
+    }
+
+    do
+    {
+        ticks   = sysTickReadTick64();
+        val_1   = SysTick->VAL;
+        pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+        val_2   = SysTick->VAL;
+    } while (ticks != sysTickReadTick64());
+
+    if (val_2 > val_1)
+    {
+        /* Counter reloaded between the two reads, val_2 is in the next period */
+        ticks++;
+        val_1 = val_2;
+    }
+    else if ((pending != 0u) && (val_1 != 0u))
+    {
+        /* Reload happened before val_1 was read but has not been counted,
+         * with VAL at zero the pending tick still belongs to this period */
+        ticks++;
+    }
+
+    uint64_t cycles = (ticks * ((uint64_t)load + 1u)) + (uint64_t)(load - val_1);
+    uint64_t sec = cycles / systick_clk_hz;
+    uint64_t rem = cycles % systick_clk_hz;
+
+    return (sec * 1000000u) + ((rem * 1000000u) / systick_clk_hz);
+}
+
+/**
+ * @brief  This function returns milliseconds elapsed since a start tick.
+ * @param  start Value previously returned by sysTickGetTick().
+ * @return Elapsed ticks, correct across the 32-bit wrap.
+ */
+uint32_t sysTickElapsed(uint32_t start)
+{
+    return tick - start;
+}
+
+/**
+ * @brief   This function sleeps until the next deadline without periodic ticks.
+ * @details SysTick is reprogrammed to fire after idle_ticks periods (limited by
+ *          the 24-bit LOAD register) and the core waits in WFI. All counts are
+ *          taken relative to the tick boundary the counter was heading to on
+ *          entry, and the clocks spent with the counter stopped are measured
+ *          on CYCCNT and added back, so the tick grid does not drift.
+ * @param   idle_ticks Number of tick periods until the next scheduled deadline.
+ * @return  Number of tick periods accounted here, the SysTick ISR adds the last.
+ */
+uint32_t sysTickIdle(uint32_t idle_ticks)
+{
+    uint32_t period = systick_cycles_per_tick;
+    uint32_t slept = 0u;
+
+    if ((idle_ticks < 2u) || (period == 0u))
+    {
+        return 0u;
+    }
+
+    uint32_t max_ticks = (SysTick_LOAD_RELOAD_Msk / period);
+    if (idle_ticks > max_ticks)
+    {
+        idle_ticks = max_ticks;
+    }
+
+    if (idle_ticks < 2u)
+    {
+        return 0u;
+    }
+
+    sysTickCycleCounterOn();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u)
+    {
+        /* A tick is already pending, do not sleep through it */
+        __set_PRIMASK(primask);
+        return 0u;
+    }
+
+    /* Stop the counter while computing so VAL does not move */
+    uint32_t stopped_at = DWT->CYCCNT;
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    uint32_t val_entry = SysTick->VAL;
+
+    if ((val_entry == 0u) || ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u))
+    {
+        /* The boundary was crossed just before the stop, leave it to the ISR */
+        slept = sysTickResume((val_entry != 0u) ? val_entry : period, stopped_at);
+        sysTickAdvance(slept);
+        __set_PRIMASK(primask);
+        return slept;
+    }
+
+    /* val_entry clocks to the first boundary, then idle_ticks - 1 whole periods */
+    uint32_t skipped = sysTickResume(val_entry + (period * (idle_ticks - 1u)), stopped_at);
+
+    __DSB();
+    __WFI();
+    __ISB();
+
+    stopped_at = DWT->CYCCNT;
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    uint32_t val_wake = SysTick->VAL;
+    uint32_t next;
+
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u)
+    {
+        /* Deadline reached, the pending SysTick ISR accounts for the last period */
+        slept = idle_ticks - 1u;
+        next = (val_wake != 0u) ? val_wake : period;
+    }
+    else
+    {
+        /* Woken early, val_wake clocks are left to the deadline boundary */
+        uint32_t ahead = (val_wake + (period - 1u)) / period;
+
+        slept = idle_ticks - ahead;
+        next = ((val_wake - 1u) % period) + 1u;
+    }
+
+    slept += skipped + sysTickResume(next, stopped_at);
+    sysTickAdvance(slept);
+
+    __set_PRIMASK(primask);
+
+    return slept;
+}
+
+/**
+ * @brief This function handles SysTick interrupt.
+ * @return None.
+ */
+void sysTickHandleIrq(void)
+{
+    sysTickAdvance(1u);
+}
+
+/** 
+ * @section Private Function Definations.
+ */
+
+/**
+ * @brief   This function reads the 64-bit tick count without locking.
+ * @details The count is read from the slot selected by tick_seq. The writer
+ *          only fills the other slot before bumping tick_seq, so a reader
+ *          that preempts it still sees a complete value, and a reader that
+ *          was preempted sees tick_seq change and retries.
+ * @return  Consistent 64-bit tick count.
+ */
+static uint64_t sysTickReadTick64(void)
+{
+    uint32_t seq;
+    uint64_t value;
+
+    do
+    {
+        seq = tick_seq;
+        __DMB();
+        value = tick_slot[seq & 1u];
+        __DMB();
+    } while (seq != tick_seq);
+
+    return value;
+}
+
+/**
+ * @brief  This function adds tick periods to the 64-bit tick count.
+ * @note   Must only be called from the SysTick ISR or with interrupts masked.
+ * @param  ticks Number of periods to add.
+ * @return None.
+ */
+static void sysTickAdvance(uint32_t ticks)
+{
+    uint32_t seq = tick_seq;
+    uint64_t next = tick_slot[seq & 1u] + ticks;
+
+    /* Fill the idle slot, then publish it with a single 32-bit store */
+    tick_slot[(seq + 1u) & 1u] = next;
+    __DMB();
+    tick_seq = seq + 1u;
+    tick = (uint32_t)next;
+}
+
+/**
+ * @brief   This function restarts a stopped SysTick on the tick grid.
+ * @details The clocks spent stopped since stopped_at are read back from
+ *          CYCCNT and taken off the first reload, so the next boundary fires
+ *          exactly next clocks after the stop. A boundary that already passed
+ *          while stopped is skipped and counted; one that is only a few clocks
+ *          away is waited out so the first reload is never too short to latch
+ *          the normal period behind it. Must be called with interrupts masked.
+ * @param   next Clocks from the stop to the next tick boundary, at least 1.
+ * @param   stopped_at CYCCNT value read right before the counter was stopped.
+ * @return  Number of boundaries skipped while stopped.
+ */
+static uint32_t sysTickResume(uint32_t next, uint32_t stopped_at)
+{
+    uint32_t period = systick_cycles_per_tick;
+    uint32_t clk_div = ((SysTick->CTRL & SysTick_CTRL_CLKSOURCE_Msk) != 0u) ? 1u : 8u;
+    uint32_t skipped = 0u;
+    uint32_t lost;
+
+    SysTick->VAL = 0u;
+
+    for (;;)
+    {
+        lost = (DWT->CYCCNT - stopped_at) / clk_div;
+
+        if (next > (lost + SYSTICK_RESUME_MARGIN))
+        {
+            break;
+        }
+        if (next <= lost)
+        {
+            next += period;
+            skipped++;
+        }
+    }
+
+    /* With VAL at zero the first clock reloads, then LOAD clocks to the boundary */
+    SysTick->LOAD = next - lost - 1u;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    /* The normal period may only be written once the first reload has latched */
+    while (SysTick->VAL == 0u)
+    {
+        __NOP();
+    }
+    SysTick->LOAD = period - 1u;
+
+    return skipped;
+}
+
+/**
+ * @brief   This function programs SysTick for a tick rate from the current HCLK.
+ * @details A running counter keeps its position in the current period: the
+ *          fraction left of the old period is scaled to the new reload, so a
+ *          clock change neither drops nor stretches the tick in progress.
+ * @param   rate_hz Tick rate in Hz.
+ * @return  SYSTICK_OK on success, SYSTICK_ERR_CFG if the rate cannot be reached.
+ */
+static int sysTickProgram(uint32_t rate_hz)
+{
+    uint32_t hclk = rccGetHCLK();
+    uint32_t clk_hz = hclk;
+    uint32_t ctrl = SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_CLKSOURCE_Msk;
+
+    if (rate_hz == 0u)
+    {
+        return SYSTICK_ERR_CFG;
+    }
+
+    uint32_t ticks = (clk_hz + (rate_hz / 2u)) / rate_hz;
+
+    if ((ticks - 1u) > SysTick_LOAD_RELOAD_Msk)
+    {
+        /* Too slow for the core clock, fall back to the HCLK/8 reference */
+        clk_hz = hclk / 8u;
+        ticks = (clk_hz + (rate_hz / 2u)) / rate_hz;
+        ctrl &= ~SysTick_CTRL_CLKSOURCE_Msk;
+    }
+
+    if ((ticks < 2u) || ((ticks - 1u) > SysTick_LOAD_RELOAD_Msk))
+    {
+        return SYSTICK_ERR_CFG;
+    }
+
+    sysTickCycleCounterOn();
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t old_period = systick_cycles_per_tick;
+    uint32_t running = SysTick->CTRL & SysTick_CTRL_ENABLE_Msk;
+    uint32_t stopped_at = DWT->CYCCNT;
+
+    SysTick->CTRL = 0u;
+
+    systick_clk_hz = clk_hz;
+    systick_cycles_per_tick = ticks;
+    systick_rate_hz = rate_hz;
+
+    if ((running != 0u) && (old_period != 0u))
+    {
+        /* Carry the unfinished part of the current period over to the new reload */
+        uint32_t val = SysTick->VAL;
+        uint64_t left = (val != 0u) ? val : old_period;
+        uint32_t next = (uint32_t)(((left * ticks) + (old_period / 2u)) / old_period);
+
+        SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+        sysTickAdvance(sysTickResume((next != 0u) ? next : 1u, stopped_at));
+    }
+    else
+    {
+        SysTick->LOAD = ticks - 1u;
+        SysTick->VAL  = 0u;
+        SysTick->CTRL = ctrl;
+    }
+
+    __set_PRIMASK(primask);
+
+    return SYSTICK_OK;
+}
+
+/**
+ * @brief  This function makes sure the DWT cycle counter is running.
+ * @return None.
+ */
+static void sysTickCycleCounterOn(void)
+{
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0u)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+/**
+ * @brief  This function re-derives the SysTick reload after a clock change.
+ * @return None.
+ */
+static void sysTickClockChanged(void)
+{
+    if (systick_rate_hz != 0u)
+    {
+        (void)sysTickProgram(systick_rate_hz);
+    }
+}
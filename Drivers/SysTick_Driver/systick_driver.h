@@ -11,6 +11,12 @@
 #include <stdint.h>
 #include "stm32f446xx.h"
 
+/**
+ * @section Public Macro Definations.
+ */
+#define SYSTICK_OK         0
+#define SYSTICK_ERR_CFG   -1
+
 /** 
  * @section Public Data Declarations.
  */
@@ -19,8 +25,15 @@ extern volatile uint32_t tick;
 /** 
  * @section Public Function Declarations.
  */
-void sysTickInit(uint32_t ticks);
+int sysTickInit(uint32_t ticks);
+int sysTickInitHz(uint32_t rate_hz, uint8_t priority);
 void sysTickDelayMs(uint32_t ms);
+void sysTickSleepMs(uint32_t ms);
 uint32_t sysTickGetTick(void);
+uint64_t sysTickGetTick64(void);
+uint64_t sysTickGetUs64(void);
+uint32_t sysTickElapsed(uint32_t start);
+uint32_t sysTickIdle(uint32_t idle_ticks);
+void sysTickHandleIrq(void);
 
 #endif
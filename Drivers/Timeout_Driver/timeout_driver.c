@@ -0,0 +1,148 @@
+/**
+ * @file    timeout_driver.c
+ * @author  Pratik Dhulubulu
+ * @brief   This file implements cycle-counter deadlines, tick deadlines and
+ *          time-bounded register polling.
+ */
+
+#include "timeout_driver.h"
+#include "systick_driver.h"
+
+/**
+ * @section Private Function Declarations.
+ */
+static uint32_t timeoutCyclesPerUs(void);
+
+/**
+ * @section Public Function Definations.
+ */
+
+/**
+ * @brief  This function starts a microsecond deadline.
+ * @param  ptr_timeout Pointer to deadline object.
+ * @param  us Length in microseconds.
+ * @return None.
+ */
+void timeoutStartUs(TIMEOUT *ptr_timeout, uint32_t us)
+{
+    uint32_t cycles_per_us = timeoutCyclesPerUs();
+    uint32_t max_us = UINT32_MAX / cycles_per_us;
+
+    ptr_timeout->start = DWT->CYCCNT;
+    ptr_timeout->cycles = (us > max_us) ? UINT32_MAX : (us * cycles_per_us);
+}
+
+/**
+ * @brief  This function checks whether a deadline has passed.
+ * @param  ptr_timeout Pointer to deadline object.
+ * @return 1 if expired, otherwise 0.
+ */
+uint8_t timeoutExpired(const TIMEOUT *ptr_timeout)
+{
+    return (uint8_t)((DWT->CYCCNT - ptr_timeout->start) >= ptr_timeout->cycles);
+}
+
+/**
+ * @brief  This function returns the time since a deadline was started.
+ * @param  ptr_timeout Pointer to deadline object.
+ * @return Elapsed microseconds.
+ */
+uint32_t timeoutElapsedUs(const TIMEOUT *ptr_timeout)
+{
+    return (DWT->CYCCNT - ptr_timeout->start) / timeoutCyclesPerUs();
+}
+
+/**
+ * @brief  This function starts a deadline on the 64-bit SysTick count.
+ * @param  ptr_timeout Pointer to deadline object.
+ * @param  ticks Length in SysTick periods.
+ * @return None.
+ */
+void timeoutStartTicks(TIMEOUT_TICK *ptr_timeout, uint32_t ticks)
+{
+    ptr_timeout->deadline = sysTickGetTick64() + ticks;
+}
+
+/**
+ * @brief  This function checks whether a tick deadline has passed.
+ * @param  ptr_timeout Pointer to deadline object.
+ * @return 1 if expired, otherwise 0.
+ */
+uint8_t timeoutTickExpired(const TIMEOUT_TICK *ptr_timeout)
+{
+    return (uint8_t)(sysTickGetTick64() >= ptr_timeout->deadline);
+}
+
+/**
+ * @brief  This function waits until all bits of a mask are set.
+ * @param  ptr_reg Pointer to the register.
+ * @param  mask Bits to wait for.
+ * @param  us Time bound in microseconds.
+ * @return TIMEOUT_OK if set in time, otherwise TIMEOUT_EXPIRED.
+ */
+int timeoutWaitSet(volatile uint32_t *ptr_reg, uint32_t mask, uint32_t us)
+{
+    return timeoutWaitValue(ptr_reg, mask, mask, us);
+}
+
+/**
+ * @brief  This function waits until all bits of a mask are clear.
+ * @param  ptr_reg Pointer to the register.
+ * @param  mask Bits to wait for.
+ * @param  us Time bound in microseconds.
+ * @return TIMEOUT_OK if cleared in time, otherwise TIMEOUT_EXPIRED.
+ */
+int timeoutWaitClear(volatile uint32_t *ptr_reg, uint32_t mask, uint32_t us)
+{
+    return timeoutWaitValue(ptr_reg, mask, 0u, us);
+}
+
+/**
+ * @brief   This function waits until a register field reads a value.
+ * @details The register is checked once more after expiry, so a preempted
+ *          caller does not report a timeout for a condition that became true.
+ * @param   ptr_reg Pointer to the register.
+ * @param   mask Field mask.
+ * @param   value Expected field value (already shifted).
+ * @param   us Time bound in microseconds.
+ * @return  TIMEOUT_OK if matched in time, otherwise TIMEOUT_EXPIRED.
+ */
+int timeoutWaitValue(volatile uint32_t *ptr_reg, uint32_t mask, uint32_t value, uint32_t us)
+{
+    TIMEOUT timeout;
+
+    timeoutStartUs(&timeout, us);
+
+    while ((*ptr_reg & mask) != value)
+    {
+        if (timeoutExpired(&timeout) != 0u)
+        {
+            return ((*ptr_reg & mask) == value) ? TIMEOUT_OK : TIMEOUT_EXPIRED;
+        }
+    }
+
+    return TIMEOUT_OK;
+}
+
+/**
+ * @section Private Function Definations.
+ */
+
+/**
+ * @brief   This function returns core cycles per microsecond.
+ * @details Also makes sure CYCCNT is running, so deadlines work before any
+ *          other driver has enabled the DWT.
+ * @return  Cycles per microsecond, at least 1.
+ */
+static uint32_t timeoutCyclesPerUs(void)
+{
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0u)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    uint32_t cycles_per_us = SystemCoreClock / 1000000u;
+
+    return (cycles_per_us != 0u) ? cycles_per_us : 1u;
+}
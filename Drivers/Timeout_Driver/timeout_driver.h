@@ -0,0 +1,47 @@
+/**
+ * @file    timeout_driver.h
+ * @author  Pratik Dhulubulu
+ * @brief   Deadline and Timeout Interface.
+ * @details Short deadlines run on the DWT cycle counter (up to one CYCCNT
+ *          period, about 25 s at 168 MHz); long ones on the 64-bit SysTick
+ *          tick. Bounded register wait helpers replace loop-count timeouts.
+ */
+
+#ifndef TIMEOUT_DRIVER_H
+#define TIMEOUT_DRIVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "stm32f446xx.h"
+
+/**
+ * @section Public Macro Definations.
+ */
+#define TIMEOUT_OK         0
+#define TIMEOUT_EXPIRED   -1
+
+/**
+ * @section Public Type Declarations.
+ */
+typedef struct {
+    uint32_t start;     /* CYCCNT at start */
+    uint32_t cycles;    /* Length in core cycles */
+} TIMEOUT;
+
+typedef struct {
+    uint64_t deadline;  /* Absolute 64-bit tick */
+} TIMEOUT_TICK;
+
+/**
+ * @section Public Function Declarations.
+ */
+void timeoutStartUs(TIMEOUT *ptr_timeout, uint32_t us);
+uint8_t timeoutExpired(const TIMEOUT *ptr_timeout);
+uint32_t timeoutElapsedUs(const TIMEOUT *ptr_timeout);
+void timeoutStartTicks(TIMEOUT_TICK *ptr_timeout, uint32_t ticks);
+uint8_t timeoutTickExpired(const TIMEOUT_TICK *ptr_timeout);
+int timeoutWaitSet(volatile uint32_t *ptr_reg, uint32_t mask, uint32_t us);
+int timeoutWaitClear(volatile uint32_t *ptr_reg, uint32_t mask, uint32_t us);
+int timeoutWaitValue(volatile uint32_t *ptr_reg, uint32_t mask, uint32_t value, uint32_t us);
+
+#endif
@@ -7,193 +7,2842 @@
 
 #include "timer_driver.h"
 #include "rcc_driver.h"
+#include "dma_driver.h"
+
+/**
+ * @section Private Macro Definations.
+ */
+#define TIM_EVENT_FLAGS     ((1UL << TIM_EVENT_MAX) - 1UL)
+
+/* Sequencer states */
+#define TIM_SEQ_IDLE        0u
+#define TIM_SEQ_DMA         1u      /* Steps 2 .. n-1 streaming through DMA */
+#define TIM_SEQ_LAST        2u      /* Last step preloaded, next update loads it */
+#define TIM_SEQ_STOPPING    3u      /* Last step playing, OPM stops the counter */
+
+/* Handle states */
+#define TIM_STATE_FREE      0u
+#define TIM_STATE_OWNED     1u
+#define TIM_STATE_READY     2u
+#define TIM_STATE_RUNNING   3u
+
+#define TIM_SEQ_WORDS       (sizeof(TIM_SEQ_STEP) / sizeof(uint32_t))
+
+_Static_assert(sizeof(TIM_SEQ_STEP) == (6u * sizeof(uint32_t)), "TIM_SEQ_STEP must match the ARR..CCR4 burst");
+
+/**
+ * @section Private Type Declarations.
+ */
+typedef struct {
+    fp_tim_callback callback;
+    void *ptr_ctx;
+} TIM_CALLBACK_ENTRY;
+
+typedef struct {
+    DMA_Stream_TypeDef *ptr_stream;
+    uint32_t channel;
+} TIM_DMA_REQUEST;
+
+struct TIM_HANDLE {
+    TIM_TypeDef *ptr_tim;
+    uint32_t clock_hz;
+    uint32_t caps;
+    uint8_t channels;
+    uint8_t state;
+    const void *ptr_owner;
+    DMA_Stream_TypeDef *ptr_stream;     /* Stream held by the running service, NULL if none */
+};
+
+typedef struct {
+    uint8_t ccmr;           /* 0 for CCMR1, 1 for CCMR2 */
+    uint8_t ccmr_shift;
+    uint8_t ccer_shift;
+    uint8_t ois_shift;
+} TIM_CHANNEL_LAYOUT;
+
+/**
+ * @section Private Data Definations.
+ */
+static TIM_CALLBACK_ENTRY tim_callback_table[TIM_ID_MAX][TIM_EVENT_MAX];
+
+/* DMA request mapping (RM0390 tables 28/29), indexed by TIM_EVENT UPDATE..CC4 */
+static const TIM_DMA_REQUEST tim_dma_table[TIM_ID_MAX][TIM_EVENT_CC4 + 1u] = {
+    [TIM_ID_1] = { { DMA2_Stream5, 6u }, { DMA2_Stream1, 6u }, { DMA2_Stream2, 6u },
+                   { DMA2_Stream6, 6u }, { DMA2_Stream4, 6u } },
+    [TIM_ID_2] = { { DMA1_Stream1, 3u }, { DMA1_Stream5, 3u }, { DMA1_Stream6, 3u },
+                   { DMA1_Stream1, 3u }, { DMA1_Stream7, 3u } },
+    [TIM_ID_3] = { { DMA1_Stream2, 5u }, { DMA1_Stream4, 5u }, { DMA1_Stream5, 5u },
+                   { DMA1_Stream7, 5u }, { DMA1_Stream2, 5u } },
+    [TIM_ID_4] = { { DMA1_Stream6, 2u }, { DMA1_Stream0, 2u }, { DMA1_Stream3, 2u },
+                   { DMA1_Stream7, 2u }, { NULL, 0u } },
+    [TIM_ID_5] = { { DMA1_Stream6, 6u }, { DMA1_Stream2, 6u }, { DMA1_Stream4, 6u },
+                   { DMA1_Stream0, 6u }, { DMA1_Stream1, 6u } },
+    [TIM_ID_8] = { { DMA2_Stream1, 7u }, { DMA2_Stream2, 7u }, { DMA2_Stream3, 7u },
+                   { DMA2_Stream4, 7u }, { DMA2_Stream7, 7u } }
+};
+
+static const RCC_PERIPH tim_periph_table[TIM_ID_MAX] = {
+    RCC_PERIPH_TIM1,  RCC_PERIPH_TIM2,  RCC_PERIPH_TIM3,  RCC_PERIPH_TIM4,
+    RCC_PERIPH_TIM5,  RCC_PERIPH_TIM6,  RCC_PERIPH_TIM7,  RCC_PERIPH_TIM8,
+    RCC_PERIPH_TIM9,  RCC_PERIPH_TIM10, RCC_PERIPH_TIM11, RCC_PERIPH_TIM12,
+    RCC_PERIPH_TIM13, RCC_PERIPH_TIM14
+};
+
+static const TIM_CHANNEL_LAYOUT tim_channel_table[4] = {
+    [TIM_CHANNEL_1] = { 0u, 0u, 0u,  TIM_CR2_OIS1_Pos },
+    [TIM_CHANNEL_2] = { 0u, 8u, 4u,  TIM_CR2_OIS2_Pos },
+    [TIM_CHANNEL_3] = { 1u, 0u, 8u,  TIM_CR2_OIS3_Pos },
+    [TIM_CHANNEL_4] = { 1u, 8u, 12u, TIM_CR2_OIS4_Pos }
+};
+
+/* Timestamp source, epoch counts half wraps of the 32-bit counter */
+static TIM_TypeDef *ts_tim;
+static volatile uint32_t ts_epoch;
+static uint32_t ts_hz;
+
+/* Internal trigger sources ITR0..ITR3 of each slave (RM0390 TIMx internal trigger tables) */
+static const TIM_ID tim_itr_table[TIM_ID_MAX][4] = {
+    [TIM_ID_1]  = { TIM_ID_5,   TIM_ID_2,   TIM_ID_3,   TIM_ID_4   },
+    [TIM_ID_2]  = { TIM_ID_1,   TIM_ID_8,   TIM_ID_3,   TIM_ID_4   },
+    [TIM_ID_3]  = { TIM_ID_1,   TIM_ID_2,   TIM_ID_5,   TIM_ID_4   },
+    [TIM_ID_4]  = { TIM_ID_1,   TIM_ID_2,   TIM_ID_3,   TIM_ID_8   },
+    [TIM_ID_5]  = { TIM_ID_2,   TIM_ID_3,   TIM_ID_4,   TIM_ID_8   },
+    [TIM_ID_6]  = { TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX },
+    [TIM_ID_7]  = { TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX },
+    [TIM_ID_8]  = { TIM_ID_1,   TIM_ID_2,   TIM_ID_4,   TIM_ID_5   },
+    [TIM_ID_9]  = { TIM_ID_2,   TIM_ID_3,   TIM_ID_10,  TIM_ID_11  },
+    [TIM_ID_10] = { TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX },
+    [TIM_ID_11] = { TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX },
+    [TIM_ID_12] = { TIM_ID_4,   TIM_ID_5,   TIM_ID_13,  TIM_ID_14  },
+    [TIM_ID_13] = { TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX },
+    [TIM_ID_14] = { TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX, TIM_ID_MAX }
+};
+
+static const uint8_t tim_channel_count[TIM_ID_MAX] = {
+    4u, 4u, 4u, 4u, 4u, 0u, 0u, 4u, 2u, 1u, 1u, 2u, 1u, 1u
+};
+
+static const uint32_t tim_caps_table[TIM_ID_MAX] = {
+    [TIM_ID_1]  = TIM_CAP_ADVANCED | TIM_CAP_MASTER | TIM_CAP_SLAVE | TIM_CAP_ENCODER | TIM_CAP_DMA,
+    [TIM_ID_2]  = TIM_CAP_32BIT | TIM_CAP_MASTER | TIM_CAP_SLAVE | TIM_CAP_ENCODER | TIM_CAP_DMA,
+    [TIM_ID_3]  = TIM_CAP_MASTER | TIM_CAP_SLAVE | TIM_CAP_ENCODER | TIM_CAP_DMA,
+    [TIM_ID_4]  = TIM_CAP_MASTER | TIM_CAP_SLAVE | TIM_CAP_ENCODER | TIM_CAP_DMA,
+    [TIM_ID_5]  = TIM_CAP_32BIT | TIM_CAP_MASTER | TIM_CAP_SLAVE | TIM_CAP_ENCODER | TIM_CAP_DMA,
+    [TIM_ID_6]  = TIM_CAP_MASTER,
+    [TIM_ID_7]  = TIM_CAP_MASTER,
+    [TIM_ID_8]  = TIM_CAP_ADVANCED | TIM_CAP_MASTER | TIM_CAP_SLAVE | TIM_CAP_ENCODER | TIM_CAP_DMA,
+    [TIM_ID_9]  = TIM_CAP_SLAVE,
+    [TIM_ID_10] = 0u,
+    [TIM_ID_11] = 0u,
+    [TIM_ID_12] = TIM_CAP_SLAVE,
+    [TIM_ID_13] = 0u,
+    [TIM_ID_14] = 0u
+};
+
+static TIM_HANDLE tim_handle_table[TIM_ID_MAX];
 
 /**
  * @section Private Function Declarations.
  */
-static void timerConfigBase(const TIM_CONFIG *ptr_cfg);
-static void timerConfigPwm(const TIM_CONFIG *ptr_cfg);
-static void timerConfigInputCapture(const TIM_CONFIG *ptr_cfg);
-static void timerConfigOutputCompare(const TIM_CONFIG *ptr_cfg);
-static void timerConfigEncoder(const TIM_CONFIG *ptr_cfg);
+static int timerClaim(TIM_TypeDef *ptr_tim, const void *ptr_owner);
+static uint8_t timerIsOwner(const TIM_TypeDef *ptr_tim, const void *ptr_owner);
+static void timerBindStream(const TIM_TypeDef *ptr_tim, DMA_Stream_TypeDef *ptr_stream);
+static void timerReleaseStream(const TIM_TypeDef *ptr_tim);
+static void timerApplyConfig(const TIM_CONFIG *ptr_cfg);
+static void timerConfigBase(const TIM_CONFIG *ptr_cfg);
+static void timerConfigPwm(const TIM_CONFIG *ptr_cfg);
+static void timerConfigInputCapture(const TIM_CONFIG *ptr_cfg);
+static void timerConfigOutputCompare(const TIM_CONFIG *ptr_cfg);
+static void timerConfigEncoder(const TIM_CONFIG *ptr_cfg);
+static const TIM_DMA_REQUEST *timerGetDmaRequest(const TIM_TypeDef *ptr_tim, TIM_EVENT event);
+static uint8_t timerIsAdvanced(const TIM_TypeDef *ptr_tim);
+static uint32_t timerGetCounterMask(const TIM_TypeDef *ptr_tim);
+static void timerConfigIcChannel(TIM_TypeDef *ptr_tim, TIM_CHANNEL channel, uint32_t ccs,
+                                 TIM_IC_EDGE edge, uint32_t filter, uint32_t divider);
+static void timerEncoderWrap(void *ptr_ctx);
+static int timerGetItr(const TIM_TypeDef *ptr_slave, const TIM_TypeDef *ptr_master);
+static volatile uint32_t *timerGetCcmr(TIM_TypeDef *ptr_tim, TIM_CHANNEL channel);
+static void timerTimestampHalfWrap(void *ptr_ctx);
+static void timerClockChanged(void);
+static void timerSeqLoad(TIM_TypeDef *ptr_tim, const TIM_SEQ_STEP *ptr_step);
+static void timerSeqDmaDone(void *ptr_ctx);
+static void timerSeqUpdate(void *ptr_ctx);
+static void timerConfigOcChannel(TIM_TypeDef *ptr_tim, const TIM_CHANNEL_CONFIG *ptr_ch, TIM_OC_MODE oc_mode);
+static int timerDeadTimeEncode(uint32_t timclk_hz, uint32_t ns, uint32_t *ptr_ckd, uint32_t *ptr_dtg);
+
+/**
+ * @section Public Function Definations.
+ */
+
+/**
+ * @brief   This function initializes timer as per provided configuration.
+ * @details The timer is claimed with ptr_cfg as owner until timerDeinit(),
+ *          so only this configuration can start, stop or reinitialise it.
+ * @param   ptr_cfg Pointer to timer configuration structure.
+ * @return  TIM_OK on success, TIM_ERR_CFG if ptr_tim is not a timer,
+ *          TIM_ERR_BUSY if the timer is owned by someone else.
+ */
+int timerInit(const TIM_CONFIG *ptr_cfg)
+{
+    int status = timerClaim(ptr_cfg->ptr_tim, ptr_cfg);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    timerApplyConfig(ptr_cfg);
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function starts the timer counter.
+ * @param   ptr_cfg Pointer to timer configuration structure.
+ * @return  TIM_OK on success, TIM_ERR_BUSY if ptr_cfg does not own the timer.
+ */
+int timerStart(const TIM_CONFIG *ptr_cfg)
+{
+    if (timerIsOwner(ptr_cfg->ptr_tim, ptr_cfg) == 0u)
+    {
+        return TIM_ERR_BUSY;
+    }
+
+    ptr_cfg->ptr_tim->CR1 |= TIM_CR1_CEN;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function stops the timer counter.
+ * @param   ptr_cfg Pointer to timer configuration structure.
+ * @return  TIM_OK on success, TIM_ERR_BUSY if ptr_cfg does not own the timer.
+ */
+int timerStop(const TIM_CONFIG *ptr_cfg)
+{
+    if (timerIsOwner(ptr_cfg->ptr_tim, ptr_cfg) == 0u)
+    {
+        return TIM_ERR_BUSY;
+    }
+
+    ptr_cfg->ptr_tim->CR1 &= ~TIM_CR1_CEN;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function returns the index of a timer instance.
+ * @param   ptr_tim Pointer to timer instance.
+ * @return  Timer ID, TIM_ID_MAX if the pointer is not a timer.
+ */
+TIM_ID timerGetId(const TIM_TypeDef *ptr_tim)
+{
+    static TIM_TypeDef * const tim_table[TIM_ID_MAX] = {
+        TIM1, TIM2, TIM3, TIM4, TIM5, TIM6, TIM7,
+        TIM8, TIM9, TIM10, TIM11, TIM12, TIM13, TIM14
+    };
+
+    for (uint32_t id = 0u; id < (uint32_t)TIM_ID_MAX; id++)
+    {
+        if (tim_table[id] == ptr_tim)
+        {
+            return (TIM_ID)id;
+        }
+    }
+
+    return TIM_ID_MAX;
+}
+
+/**
+ * @brief   This function claims exclusive use of a timer.
+ * @details The handle caches the timer clock, refreshed on clock changes,
+ *          and the capability flags of the instance. The timer bus clock is
+ *          enabled until timerRelease(). The services that take a timer
+ *          (timerInit(), timerCaptureInit(), timerEncoderInit() ...) claim it
+ *          the same way, so a timer in use by one of them is not handed out.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   ptr_owner Non-NULL tag identifying the owner.
+ * @return  Handle, NULL if the timer is invalid or owned by someone else.
+ */
+TIM_HANDLE *timerAcquire(TIM_TypeDef *ptr_tim, const void *ptr_owner)
+{
+    if (timerClaim(ptr_tim, ptr_owner) != TIM_OK)
+    {
+        return NULL;
+    }
+
+    return &tim_handle_table[timerGetId(ptr_tim)];
+}
+
+/**
+ * @brief   This function stops a timer and gives up ownership.
+ * @param   ptr_handle Timer handle.
+ * @param   ptr_owner Owner tag passed to timerAcquire().
+ * @return  TIM_OK on success, TIM_ERR_CFG if not the owner.
+ */
+int timerRelease(TIM_HANDLE *ptr_handle, const void *ptr_owner)
+{
+    if (ptr_handle == NULL)
+    {
+        return TIM_ERR_CFG;
+    }
+
+    return timerDeinit(ptr_handle->ptr_tim, ptr_owner);
+}
+
+/**
+ * @brief   This function stops a timer and releases it from its service.
+ * @details The counter, the timer interrupts and DMA requests are stopped,
+ *          the event callbacks are dropped and the DMA stream held by a
+ *          capture, sequencer, audio or burst service is released.
+ *          The owner is the object the timer was set up with: the config for
+ *          timerInit(), timerOnePulseInit() and timerCompPwmInit(), the
+ *          capture, encoder, sequencer or audio object for those services,
+ *          and the timer itself for timerTimestampInit(),
+ *          timerSampleClockInit() and timerPwmInputInit().
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   ptr_owner Owner tag the timer was claimed with.
+ * @return  TIM_OK on success, TIM_ERR_CFG if not the owner.
+ */
+int timerDeinit(TIM_TypeDef *ptr_tim, const void *ptr_owner)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if ((id >= TIM_ID_MAX) || (tim_handle_table[id].state == TIM_STATE_FREE) ||
+        (tim_handle_table[id].ptr_owner != ptr_owner))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    ptr_tim->CR1 &= ~TIM_CR1_CEN;
+    ptr_tim->DIER = 0u;
+
+    timerReleaseStream(ptr_tim);
+
+    for (uint32_t event = 0u; event < (uint32_t)TIM_EVENT_MAX; event++)
+    {
+        tim_callback_table[id][event].callback = (fp_tim_callback)0;
+    }
+
+    rccPeriphClockDisable(tim_periph_table[id]);
+
+    tim_handle_table[id].ptr_owner = NULL;
+    tim_handle_table[id].state = TIM_STATE_FREE;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function initialises an owned timer.
+ * @details Rejects channels and modes the instance does not have before any
+ *          register is touched.
+ * @param   ptr_handle Timer handle.
+ * @param   ptr_cfg Pointer to timer configuration, ptr_tim must match.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid configuration,
+ *          TIM_ERR_BUSY while the timer is running.
+ */
+int timerHandleInit(TIM_HANDLE *ptr_handle, const TIM_CONFIG *ptr_cfg)
+{
+    if ((ptr_handle == NULL) || (ptr_cfg == NULL) || (ptr_handle->state == TIM_STATE_FREE) ||
+        (ptr_cfg->ptr_tim != ptr_handle->ptr_tim))
+    {
+        return TIM_ERR_CFG;
+    }
+    if (ptr_handle->state == TIM_STATE_RUNNING)
+    {
+        return TIM_ERR_BUSY;
+    }
+    if ((ptr_cfg->mode == TIM_MODE_ENCODER) && ((ptr_handle->caps & TIM_CAP_ENCODER) == 0u))
+    {
+        return TIM_ERR_CFG;
+    }
+    if ((ptr_cfg->mode != TIM_MODE_BASIC) && (ptr_cfg->mode != TIM_MODE_ENCODER) &&
+        ((uint32_t)ptr_cfg->channel >= ptr_handle->channels))
+    {
+        return TIM_ERR_CFG;
+    }
+    if (((ptr_handle->caps & TIM_CAP_32BIT) == 0u) && (ptr_cfg->period > 0xFFFFu))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    timerApplyConfig(ptr_cfg);
+    ptr_handle->state = TIM_STATE_READY;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function starts an initialised timer.
+ * @param   ptr_handle Timer handle.
+ * @return  TIM_OK on success, TIM_ERR_CFG if not initialised.
+ */
+int timerHandleStart(TIM_HANDLE *ptr_handle)
+{
+    if ((ptr_handle == NULL) || (ptr_handle->state < TIM_STATE_READY))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    ptr_handle->ptr_tim->CR1 |= TIM_CR1_CEN;
+    ptr_handle->state = TIM_STATE_RUNNING;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function stops a running timer.
+ * @param   ptr_handle Timer handle.
+ * @return  TIM_OK on success, TIM_ERR_CFG if not initialised.
+ */
+int timerHandleStop(TIM_HANDLE *ptr_handle)
+{
+    if ((ptr_handle == NULL) || (ptr_handle->state < TIM_STATE_READY))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    ptr_handle->ptr_tim->CR1 &= ~TIM_CR1_CEN;
+    ptr_handle->state = TIM_STATE_READY;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function returns the timer instance of a handle.
+ * @param   ptr_handle Timer handle.
+ * @return  Pointer to timer registers.
+ */
+TIM_TypeDef *timerHandleGetInstance(const TIM_HANDLE *ptr_handle)
+{
+    return ptr_handle->ptr_tim;
+}
+
+/**
+ * @brief   This function returns the cached timer kernel clock.
+ * @param   ptr_handle Timer handle.
+ * @return  Timer clock in Hz.
+ */
+uint32_t timerHandleGetClock(const TIM_HANDLE *ptr_handle)
+{
+    return ptr_handle->clock_hz;
+}
+
+/**
+ * @brief   This function returns the capability flags of a timer.
+ * @param   ptr_handle Timer handle.
+ * @return  TIM_CAP_* flags.
+ */
+uint32_t timerHandleGetCaps(const TIM_HANDLE *ptr_handle)
+{
+    return ptr_handle->caps;
+}
+
+/**
+ * @brief   This function returns the number of capture/compare channels.
+ * @param   ptr_handle Timer handle.
+ * @return  0 .. 4.
+ */
+uint8_t timerHandleGetChannels(const TIM_HANDLE *ptr_handle)
+{
+    return ptr_handle->channels;
+}
+
+/**
+ * @brief   This function sets the compare value of a channel.
+ * @details CCRx is preloaded, the value takes effect at the next update so
+ *          the current period is never cut short.
+ * @param   ptr_handle Timer handle.
+ * @param   channel Channel.
+ * @param   ticks Compare value.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid channel or released handle.
+ */
+int timerSetCompare(TIM_HANDLE *ptr_handle, TIM_CHANNEL channel, uint32_t ticks)
+{
+    if ((ptr_handle == NULL) || (ptr_handle->state == TIM_STATE_FREE) ||
+        ((uint32_t)channel >= ptr_handle->channels))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    volatile uint32_t *ptr_ccmr = timerGetCcmr(ptr_handle->ptr_tim, channel);
+    uint32_t preload = TIM_CCMR1_OC1PE << tim_channel_table[channel].ccmr_shift;
+
+    if ((*ptr_ccmr & preload) == 0u)
+    {
+        *ptr_ccmr |= preload;
+    }
+
+    (&ptr_handle->ptr_tim->CCR1)[channel] = ticks;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function sets the duty cycle of a channel.
+ * @param   ptr_handle Timer handle.
+ * @param   channel Channel.
+ * @param   permille Duty cycle in 1/1000 of the period, 0 .. 1000.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid channel, duty or
+ *          released handle.
+ */
+int timerSetDuty(TIM_HANDLE *ptr_handle, TIM_CHANNEL channel, uint32_t permille)
+{
+    if ((ptr_handle == NULL) || (ptr_handle->state == TIM_STATE_FREE) || (permille > 1000u))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    uint32_t counts = ptr_handle->ptr_tim->ARR + 1u;
+    uint32_t ticks;
+
+    /* Stay in 32-bit arithmetic for 16-bit periods */
+    if ((counts != 0u) && (counts <= (UINT32_MAX / 1000u)))
+    {
+        ticks = (counts * permille) / 1000u;
+    }
+    else
+    {
+        ticks = (uint32_t)((((uint64_t)ptr_handle->ptr_tim->ARR + 1u) * permille) / 1000u);
+    }
+
+    return timerSetCompare(ptr_handle, channel, ticks);
+}
+
+/**
+ * @brief   This function changes the period and keeps every duty cycle.
+ * @details ARR and the rescaled CCRx of output channels are written with
+ *          update events disabled, so they switch together at one update.
+ *          An update falling in this window is skipped and the old period
+ *          runs once more.
+ * @param   ptr_handle Timer handle.
+ * @param   period New ARR value.
+ * @return  TIM_OK on success, TIM_ERR_CFG if out of range or the handle is
+ *          released.
+ */
+int timerSetPeriod(TIM_HANDLE *ptr_handle, uint32_t period)
+{
+    if ((ptr_handle == NULL) || (ptr_handle->state == TIM_STATE_FREE) || (period == 0u) ||
+        (((ptr_handle->caps & TIM_CAP_32BIT) == 0u) && (period > 0xFFFFu)))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_TypeDef *ptr_tim = ptr_handle->ptr_tim;
+    uint8_t wide = ((ptr_handle->caps & TIM_CAP_32BIT) != 0u) ? 1u : 0u;
+    uint64_t old_counts = (uint64_t)ptr_tim->ARR + 1u;
+    uint64_t new_counts = (uint64_t)period + 1u;
+
+    ptr_tim->CR1 |= TIM_CR1_UDIS | TIM_CR1_ARPE;
+
+    for (uint32_t ch = 0u; ch < ptr_handle->channels; ch++)
+    {
+        const TIM_CHANNEL_LAYOUT *ptr_layout = &tim_channel_table[ch];
+        uint32_t ccmr = *timerGetCcmr(ptr_tim, (TIM_CHANNEL)ch) >> ptr_layout->ccmr_shift;
+
+        /* Output channels only, CCxS = 0 */
+        if ((ccmr & TIM_CCMR1_CC1S) == 0u)
+        {
+            volatile uint32_t *ptr_ccr = &ptr_tim->CCR1 + ch;
+
+            /* 0xFFFF * 0x10000 still fits, keep 16-bit timers off the 64-bit divide */
+            if (wide == 0u)
+            {
+                *ptr_ccr = (*ptr_ccr * (uint32_t)new_counts) / (uint32_t)old_counts;
+            }
+            else
+            {
+                *ptr_ccr = (uint32_t)(((uint64_t)*ptr_ccr * new_counts) / old_counts);
+            }
+        }
+    }
+
+    ptr_tim->ARR = period;
+    ptr_tim->CR1 &= ~TIM_CR1_UDIS;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function changes the update frequency and keeps the duty.
+ * @details Only ARR and CCRx change, the current prescaler is kept, so the
+ *          cost is a couple of divisions and it is safe from a control loop
+ *          interrupt. Use timerRetuneFrequency() outside interrupts when the
+ *          frequency needs another prescaler.
+ * @param   ptr_handle Timer handle.
+ * @param   hz New update frequency.
+ * @return  TIM_OK on success, TIM_ERR_CFG if the period does not fit the
+ *          current prescaler or the handle is released.
+ */
+int timerSetFrequency(TIM_HANDLE *ptr_handle, uint32_t hz)
+{
+    if ((ptr_handle == NULL) || (ptr_handle->state == TIM_STATE_FREE) || (hz == 0u))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    uint32_t max_arr = ((ptr_handle->caps & TIM_CAP_32BIT) != 0u) ? 0xFFFFFFFFu : 0xFFFFu;
+    uint32_t tick_hz = ptr_handle->clock_hz / (ptr_handle->ptr_tim->PSC + 1u);
+    uint32_t counts = (tick_hz + (hz / 2u)) / hz;
+
+    if ((counts < 2u) || ((counts - 1u) > max_arr))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    return timerSetPeriod(ptr_handle, counts - 1u);
+}
+
+/**
+ * @brief   This function changes the update frequency with a new prescaler.
+ * @details PSC/ARR are solved again with timerSolvePeriod(), which takes up
+ *          to about sqrt(clock / hz) steps, so call it from thread context.
+ *          PSC and ARR switch together at one update and the duty is kept.
+ * @param   ptr_handle Timer handle.
+ * @param   hz New update frequency.
+ * @return  TIM_OK on success, TIM_ERR_CFG if the frequency is out of reach
+ *          or the handle is released.
+ */
+int timerRetuneFrequency(TIM_HANDLE *ptr_handle, uint32_t hz)
+{
+    if ((ptr_handle == NULL) || (ptr_handle->state == TIM_STATE_FREE))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_TypeDef *ptr_tim = ptr_handle->ptr_tim;
+    uint32_t max_arr = ((ptr_handle->caps & TIM_CAP_32BIT) != 0u) ? 0xFFFFFFFFu : 0xFFFFu;
+    uint32_t psc;
+    uint32_t arr;
+
+    if (timerSolvePeriod(ptr_handle->clock_hz, max_arr, hz, 2u, &psc, &arr) != TIM_OK)
+    {
+        return TIM_ERR_CFG;
+    }
+
+    /* PSC is always preloaded, hold updates so it switches with ARR */
+    ptr_tim->CR1 |= TIM_CR1_UDIS;
+    ptr_tim->PSC = psc;
+    (void)timerSetPeriod(ptr_handle, arr);
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function registers a callback for a timer event.
+ * @details The event interrupt is enabled in DIER when a callback is set and
+ *          disabled when it is cleared with NULL.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   event Timer event.
+ * @param   ptr_callback Pointer to user handler function, NULL to remove.
+ * @param   ptr_ctx Context pointer passed to the handler.
+ * @return  None.
+ */
+void timerRegisterCallback(TIM_TypeDef *ptr_tim, TIM_EVENT event, fp_tim_callback ptr_callback, void *ptr_ctx)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if ((id >= TIM_ID_MAX) || (event >= TIM_EVENT_MAX))
+    {
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    tim_callback_table[id][event].callback = ptr_callback;
+    tim_callback_table[id][event].ptr_ctx = ptr_ctx;
+
+    if (ptr_callback != (fp_tim_callback)0)
+    {
+        ptr_tim->DIER |= (1UL << event);
+    }
+    else
+    {
+        ptr_tim->DIER &= ~(1UL << event);
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   This function sets priority and enables every NVIC vector of a timer.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   priority NVIC priority.
+ * @return  None.
+ */
+void timerEnableIrq(TIM_TypeDef *ptr_tim, uint8_t priority)
+{
+    static const IRQn_Type tim_irq_table[TIM_ID_MAX][4] = {
+        { TIM1_BRK_TIM9_IRQn, TIM1_UP_TIM10_IRQn, TIM1_TRG_COM_TIM11_IRQn, TIM1_CC_IRQn },
+        { TIM2_IRQn,  TIM2_IRQn,  TIM2_IRQn,  TIM2_IRQn },
+        { TIM3_IRQn,  TIM3_IRQn,  TIM3_IRQn,  TIM3_IRQn },
+        { TIM4_IRQn,  TIM4_IRQn,  TIM4_IRQn,  TIM4_IRQn },
+        { TIM5_IRQn,  TIM5_IRQn,  TIM5_IRQn,  TIM5_IRQn },
+        { TIM6_DAC_IRQn, TIM6_DAC_IRQn, TIM6_DAC_IRQn, TIM6_DAC_IRQn },
+        { TIM7_IRQn,  TIM7_IRQn,  TIM7_IRQn,  TIM7_IRQn },
+        { TIM8_BRK_TIM12_IRQn, TIM8_UP_TIM13_IRQn, TIM8_TRG_COM_TIM14_IRQn, TIM8_CC_IRQn },
+        { TIM1_BRK_TIM9_IRQn,  TIM1_BRK_TIM9_IRQn,  TIM1_BRK_TIM9_IRQn,  TIM1_BRK_TIM9_IRQn },
+        { TIM1_UP_TIM10_IRQn,  TIM1_UP_TIM10_IRQn,  TIM1_UP_TIM10_IRQn,  TIM1_UP_TIM10_IRQn },
+        { TIM1_TRG_COM_TIM11_IRQn, TIM1_TRG_COM_TIM11_IRQn, TIM1_TRG_COM_TIM11_IRQn, TIM1_TRG_COM_TIM11_IRQn },
+        { TIM8_BRK_TIM12_IRQn, TIM8_BRK_TIM12_IRQn, TIM8_BRK_TIM12_IRQn, TIM8_BRK_TIM12_IRQn },
+        { TIM8_UP_TIM13_IRQn,  TIM8_UP_TIM13_IRQn,  TIM8_UP_TIM13_IRQn,  TIM8_UP_TIM13_IRQn },
+        { TIM8_TRG_COM_TIM14_IRQn, TIM8_TRG_COM_TIM14_IRQn, TIM8_TRG_COM_TIM14_IRQn, TIM8_TRG_COM_TIM14_IRQn }
+    };
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if (id >= TIM_ID_MAX)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0u; i < 4u; i++)
+    {
+        NVIC_SetPriority(tim_irq_table[id][i], priority);
+        NVIC_EnableIRQ(tim_irq_table[id][i]);
+    }
+}
+
+/**
+ * @brief   This function handles all enabled interrupt events of a timer.
+ * @param   ptr_tim Pointer to timer instance that generated interrupt.
+ * @return  None.
+ */
+void timerHandleIrq(TIM_TypeDef *ptr_tim)
+{
+    timerHandleIrqFlags(ptr_tim, TIM_EVENT_FLAGS);
+}
+
+/**
+ * @brief   This function handles a subset of timer interrupt events.
+ * @details SR and DIER are read once. Handled flags are cleared by writing
+ *          zero to them only, SR flags are rc_w0 so a read-modify-write could
+ *          drop events raised in between. Used directly by shared vectors of
+ *          the advanced timers.
+ * @param   ptr_tim Pointer to timer instance that generated interrupt.
+ * @param   flags SR flags served by the calling vector.
+ * @return  None.
+ */
+void timerHandleIrqFlags(TIM_TypeDef *ptr_tim, uint32_t flags)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+    uint32_t pending = ptr_tim->SR & ptr_tim->DIER & flags & TIM_EVENT_FLAGS;
+
+    if (pending == 0u)
+    {
+        return;
+    }
+
+    ptr_tim->SR = ~pending;
+
+    if (id >= TIM_ID_MAX)
+    {
+        return;
+    }
+
+    for (uint32_t event = 0u; pending != 0u; event++, pending >>= 1)
+    {
+        if (((pending & 1u) != 0u) && (tim_callback_table[id][event].callback != (fp_tim_callback)0))
+        {
+            tim_callback_table[id][event].callback(tim_callback_table[id][event].ptr_ctx);
+        }
+    }
+}
+
+/**
+ * @brief   This function selects what a timer drives on its TRGO output.
+ * @details timerInit() leaves TRGO at reset, call this after it. Ownership
+ *          is not checked, the caller must own the timer.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   trgo Trigger output source.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid source or a timer
+ *          without master mode (TIM9..TIM14).
+ */
+int timerSetMaster(TIM_TypeDef *ptr_tim, TIM_TRGO trgo)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if ((id >= TIM_ID_MAX) || ((tim_caps_table[id] & TIM_CAP_MASTER) == 0u) || (trgo > TIM_TRGO_OC4REF))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    ptr_tim->CR2 = (ptr_tim->CR2 & ~TIM_CR2_MMS) | ((uint32_t)trgo << TIM_CR2_MMS_Pos);
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function makes a timer a slave of another timer's TRGO.
+ * @details Ownership is not checked, the caller must own the slave timer.
+ * @param   ptr_slave Pointer to slave timer.
+ * @param   ptr_master Pointer to master timer.
+ * @param   mode Slave mode, TIM_SLAVE_DISABLED detaches the slave.
+ * @return  TIM_OK on success, TIM_ERR_CFG if the timer has no slave mode
+ *          controller or the master is not routed to the slave on STM32F446.
+ */
+int timerSetSlave(TIM_TypeDef *ptr_slave, const TIM_TypeDef *ptr_master, TIM_SLAVE_MODE mode)
+{
+    TIM_ID id = timerGetId(ptr_slave);
+
+    if ((id >= TIM_ID_MAX) || ((tim_caps_table[id] & TIM_CAP_SLAVE) == 0u))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    if (mode == TIM_SLAVE_DISABLED)
+    {
+        ptr_slave->SMCR &= ~(TIM_SMCR_SMS | TIM_SMCR_TS);
+        return TIM_OK;
+    }
+
+    int itr = timerGetItr(ptr_slave, ptr_master);
+
+    if (itr < 0)
+    {
+        return TIM_ERR_CFG;
+    }
+
+    ptr_slave->SMCR = (ptr_slave->SMCR & ~(TIM_SMCR_SMS | TIM_SMCR_TS)) |
+                      ((uint32_t)itr << TIM_SMCR_TS_Pos) | ((uint32_t)mode << TIM_SMCR_SMS_Pos);
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function starts several timers on the same clock edge.
+ * @details Slaves are put in trigger mode on the master TRGO (enable) and
+ *          the master is delayed by MSM, so setting the master CEN starts
+ *          every counter from zero in the same cycle. Slaves must be routed
+ *          to the master, e.g. TIM1 master with TIM8 and TIM2 slaves.
+ * @param   ptr_master Pointer to master timer.
+ * @param   ptr_slaves Array of slave timers.
+ * @param   count Number of slaves.
+ * @return  TIM_OK on success, TIM_ERR_CFG if a slave is not routed.
+ */
+int timerSyncStart(TIM_TypeDef *ptr_master, TIM_TypeDef *const *ptr_slaves, uint32_t count)
+{
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        if (timerGetItr(ptr_slaves[i], ptr_master) < 0)
+        {
+            return TIM_ERR_CFG;
+        }
+    }
+
+    ptr_master->CR1 &= ~TIM_CR1_CEN;
+    ptr_master->CNT = 0u;
+    (void)timerSetMaster(ptr_master, TIM_TRGO_ENABLE);
+    ptr_master->SMCR |= TIM_SMCR_MSM;
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        ptr_slaves[i]->CR1 &= ~TIM_CR1_CEN;
+        ptr_slaves[i]->CNT = 0u;
+        (void)timerSetSlave(ptr_slaves[i], ptr_master, TIM_SLAVE_TRIGGER);
+    }
+
+    ptr_master->CR1 |= TIM_CR1_CEN;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function chains two timers into one wider counter.
+ * @details The low timer update is routed to the high timer clock input, so
+ *          the pair counts (ARRlow + 1) * (ARRhigh + 1) ticks. Both time bases
+ *          must already be set, the low timer is started by the caller.
+ * @param   ptr_low Pointer to the timer clocked by TIMCLK.
+ * @param   ptr_high Pointer to the timer clocked by the low timer overflow.
+ * @return  TIM_OK on success, TIM_ERR_CFG if the pair is not routed.
+ */
+int timerCascadeInit(TIM_TypeDef *ptr_low, TIM_TypeDef *ptr_high)
+{
+    if (timerGetItr(ptr_high, ptr_low) < 0)
+    {
+        return TIM_ERR_CFG;
+    }
+
+    (void)timerSetMaster(ptr_low, TIM_TRGO_UPDATE);
+    (void)timerSetSlave(ptr_high, ptr_low, TIM_SLAVE_EXT_CLOCK);
+
+    ptr_high->PSC = 0u;
+    ptr_high->CNT = 0u;
+    ptr_high->CR1 |= TIM_CR1_CEN;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function reads a cascaded 16:16 bit counter pair.
+ * @details The high half is read before and after the low half and the read
+ *          is repeated if a carry happened in between. Both timers must run
+ *          with ARR = 0xFFFF for the result to be a linear 32-bit count.
+ * @param   ptr_low Pointer to low timer.
+ * @param   ptr_high Pointer to high timer.
+ * @return  Combined count, high << 16 | low.
+ */
+uint32_t timerCascadeRead(const TIM_TypeDef *ptr_low, const TIM_TypeDef *ptr_high)
+{
+    uint32_t high;
+    uint32_t low;
+
+    do {
+        high = ptr_high->CNT;
+        low = ptr_low->CNT;
+    } while (high != ptr_high->CNT);
+
+    return ((high & 0xFFFFu) << 16) | (low & 0xFFFFu);
+}
+
+/**
+ * @brief   This function sets up a hardware-triggered delayed pulse.
+ * @details The counter sits stopped in one-pulse mode with the slave
+ *          controller in trigger mode, so the selected edge sets CEN in
+ *          hardware. The channel runs PWM mode 2: inactive for delay_ns,
+ *          active for width_ns, then the update stops the counter and the
+ *          next edge fires again. Edges during a pulse are ignored.
+ * @param   ptr_cfg Pointer to one-pulse configuration.
+ * @return  TIM_OK on success, TIM_ERR_CFG on unsupported trigger, channel or
+ *          timing, TIM_ERR_BUSY if the timer is owned by someone else.
+ */
+int timerOnePulseInit(const TIM_ONE_PULSE_CONFIG *ptr_cfg)
+{
+    if ((ptr_cfg == NULL) || (ptr_cfg->filter > 15u) || (ptr_cfg->width_ns == 0u) ||
+        (ptr_cfg->edge == TIM_IC_BOTH))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_TypeDef *ptr_tim = ptr_cfg->ptr_tim;
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if ((id >= TIM_ID_MAX) || (tim_channel_count[id] < 2u) ||
+        ((uint32_t)ptr_cfg->channel >= tim_channel_count[id]))
+    {
+        return TIM_ERR_CFG;
+    }
+    if (((ptr_cfg->trigger == TIM_OPM_TRIG_TI1) && (ptr_cfg->channel == TIM_CHANNEL_1)) ||
+        ((ptr_cfg->trigger == TIM_OPM_TRIG_TI2) && (ptr_cfg->channel == TIM_CHANNEL_2)))
+    {
+        return TIM_ERR_CFG;
+    }
+    if ((ptr_cfg->trigger == TIM_OPM_TRIG_ETR) && (id > TIM_ID_4) && (id != TIM_ID_8))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    /* Pick the finest tick that fits delay + width in the counter */
+    uint64_t clock_hz = timerGetClock(ptr_tim);
+    uint64_t delay = (((uint64_t)ptr_cfg->delay_ns * clock_hz) + 500000000u) / 1000000000u;
+    uint64_t width = (((uint64_t)ptr_cfg->width_ns * clock_hz) + 500000000u) / 1000000000u;
+    uint64_t range = (uint64_t)timerGetCounterMask(ptr_tim) + 1u;
+    uint64_t div = ((delay + width) / range) + 1u;
+
+    while ((((delay + (div / 2u)) / div) + ((width + (div / 2u)) / div)) > range)
+    {
+        div++;
+    }
+
+    if (div > 0x10000u)
+    {
+        return TIM_ERR_CFG;
+    }
+
+    delay = (delay + (div / 2u)) / div;
+    width = (width + (div / 2u)) / div;
+
+    /* CCRx = 0 would drive the output active before the trigger */
+    if (delay == 0u)
+    {
+        delay = 1u;
+    }
+    if (width == 0u)
+    {
+        width = 1u;
+    }
+
+    int status = timerClaim(ptr_tim, ptr_cfg);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    ptr_tim->CR1 = TIM_CR1_OPM | TIM_CR1_URS;
+    ptr_tim->PSC = (uint32_t)(div - 1u);
+    ptr_tim->ARR = (uint32_t)(delay + width - 1u);
+
+    TIM_CHANNEL_CONFIG ch = {
+        .channel  = ptr_cfg->channel,
+        .mode     = TIM_MODE_OUTPUT_COMPARE,
+        .pulse    = (uint32_t)delay,
+        .polarity = ptr_cfg->polarity
+    };
+
+    timerConfigOcChannel(ptr_tim, &ch, TIM_OC_PWM2);
+
+    uint32_t smcr = ((uint32_t)ptr_cfg->trigger << TIM_SMCR_TS_Pos) |
+                    ((uint32_t)TIM_SLAVE_TRIGGER << TIM_SMCR_SMS_Pos);
+
+    if (ptr_cfg->trigger == TIM_OPM_TRIG_ETR)
+    {
+        smcr |= (ptr_cfg->filter << TIM_SMCR_ETF_Pos);
+        if (ptr_cfg->edge == TIM_IC_FALLING)
+        {
+            smcr |= TIM_SMCR_ETP;
+        }
+    }
+    else
+    {
+        TIM_CHANNEL input = (ptr_cfg->trigger == TIM_OPM_TRIG_TI1) ? TIM_CHANNEL_1 : TIM_CHANNEL_2;
+        timerConfigIcChannel(ptr_tim, input, 1u, ptr_cfg->edge, ptr_cfg->filter, 0u);
+    }
+
+    ptr_tim->SMCR = smcr;
+
+    ptr_tim->EGR = TIM_EGR_UG;
+    ptr_tim->SR = 0u;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function fires a one-pulse timer from software.
+ * @param   ptr_tim Pointer to timer set up by timerOnePulseInit().
+ * @return  None.
+ */
+void timerOnePulseFire(TIM_TypeDef *ptr_tim)
+{
+    ptr_tim->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief   This function configures one channel of a timer.
+ * @details The time base (PSC, ARR) is left untouched. CCRx is preloaded, so
+ *          on a running timer the new pulse applies from the next update.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   ptr_ch Pointer to channel configuration.
+ * @return  TIM_OK on success, TIM_ERR_CFG if the timer lacks the channel.
+ */
+int timerConfigChannel(TIM_TypeDef *ptr_tim, const TIM_CHANNEL_CONFIG *ptr_ch)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if ((ptr_ch == NULL) || (id >= TIM_ID_MAX) || ((uint32_t)ptr_ch->channel >= tim_channel_count[id]))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    switch (ptr_ch->mode) {
+        case TIM_MODE_PWM:
+            timerConfigOcChannel(ptr_tim, ptr_ch, TIM_OC_PWM1);
+            break;
+
+        case TIM_MODE_OUTPUT_COMPARE:
+            timerConfigOcChannel(ptr_tim, ptr_ch, ptr_ch->oc_mode);
+            break;
+
+        case TIM_MODE_INPUT_CAPTURE:
+            if (ptr_ch->filter > 15u)
+            {
+                return TIM_ERR_CFG;
+            }
+            timerConfigIcChannel(ptr_tim, ptr_ch->channel, 1u, ptr_ch->edge, ptr_ch->filter, 0u);
+            break;
+
+        default:
+            return TIM_ERR_CFG;
+    }
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function configures several channels of a timer from a table.
+ * @details When the counter is stopped an update is generated afterwards so
+ *          the preloaded values are active from the first period.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   ptr_table Channel configurations.
+ * @param   count Number of entries in the table.
+ * @return  TIM_OK on success, TIM_ERR_CFG on the first invalid entry.
+ */
+int timerConfigChannels(TIM_TypeDef *ptr_tim, const TIM_CHANNEL_CONFIG *ptr_table, uint32_t count)
+{
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        int status = timerConfigChannel(ptr_tim, &ptr_table[i]);
+
+        if (status != TIM_OK)
+        {
+            return status;
+        }
+    }
+
+    if ((ptr_tim->CR1 & TIM_CR1_CEN) == 0u)
+    {
+        ptr_tim->EGR = TIM_EGR_UG;
+    }
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function returns the kernel clock of a timer.
+ * @param   ptr_tim Pointer to timer instance.
+ * @return  Timer clock in Hz before the prescaler, 0 if not a timer.
+ */
+uint32_t timerGetClock(const TIM_TypeDef *ptr_tim)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if (id >= TIM_ID_MAX)
+    {
+        return 0u;
+    }
+
+    return (RCC_PERIPH_BUS(tim_periph_table[id]) == RCC_BUS_APB2) ? rccGetTIMCLK2() : rccGetTIMCLK1();
+}
+
+/**
+ * @brief   This function sets prescaler and period for an update frequency.
+ * @details clock_hz is refreshed from the RCC driver (APBx timer clock, twice
+ *          PCLKx when the bus is divided) before solving.
+ * @param   ptr_cfg Timer configuration, ptr_tim selects clock and counter width.
+ * @param   hz Wanted update frequency.
+ * @param   min_resolution Minimum number of counts per period.
+ * @return  TIM_OK on success, TIM_ERR_CFG if the frequency is out of reach.
+ */
+int timerConfigureFrequency(TIM_CONFIG *ptr_cfg, uint32_t hz, uint32_t min_resolution)
+{
+    uint32_t psc;
+    uint32_t arr;
+
+    if ((ptr_cfg == NULL) || (timerGetId(ptr_cfg->ptr_tim) >= TIM_ID_MAX))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    ptr_cfg->clock_hz = timerGetClock(ptr_cfg->ptr_tim);
+
+    if (timerSolvePeriod(ptr_cfg->clock_hz, timerGetCounterMask(ptr_cfg->ptr_tim), hz,
+                         min_resolution, &psc, &arr) != TIM_OK)
+    {
+        return TIM_ERR_CFG;
+    }
+
+    ptr_cfg->prescaler = psc;
+    ptr_cfg->period = arr;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function returns the update rate set by PSC and ARR.
+ * @param   ptr_tim Pointer to timer instance.
+ * @return  Update rate in millihertz.
+ */
+uint64_t timerGetUpdateRate(const TIM_TypeDef *ptr_tim)
+{
+    uint64_t ticks = ((uint64_t)ptr_tim->PSC + 1u) * ((uint64_t)ptr_tim->ARR + 1u);
+
+    return ((uint64_t)timerGetClock(ptr_tim) * 1000u) / ticks;
+}
+
+/**
+ * @brief   This function sets up a timer as converter sample clock.
+ * @details TRGO pulses once per period, either on update or on OCxREF rising
+ *          at the start of the period (PWM mode 1, 50 % duty). OCxREF stays
+ *          internal, the channel pin is not enabled. Use a timer/event the
+ *          ADC or DAC accepts, e.g. TIM2 TRGO, TIM8 TRGO or TIM6 TRGO for DAC.
+ *          The counter is left stopped.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   rate_hz Sample rate.
+ * @param   trgo TIM_TRGO_UPDATE or TIM_TRGO_OC1REF .. TIM_TRGO_OC4REF.
+ * @param   ptr_actual_mhz Achieved rate in millihertz, as timerGetUpdateRate(),
+ *          may be NULL.
+ * @return  TIM_OK on success, TIM_ERR_CFG if the rate or source is invalid,
+ *          TIM_ERR_BUSY if the timer is owned by someone else.
+ */
+int timerSampleClockInit(TIM_TypeDef *ptr_tim, uint32_t rate_hz, TIM_TRGO trgo, uint64_t *ptr_actual_mhz)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+    uint32_t psc;
+    uint32_t arr;
+
+    /* TIM9..TIM14 have no master mode controller */
+    if ((id > TIM_ID_8) || ((trgo != TIM_TRGO_UPDATE) && (trgo < TIM_TRGO_OC1REF)) || (trgo > TIM_TRGO_OC4REF))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_CHANNEL channel = (TIM_CHANNEL)(trgo - TIM_TRGO_OC1REF);
+
+    if ((trgo != TIM_TRGO_UPDATE) && ((uint32_t)channel >= tim_channel_count[id]))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    uint32_t clock_hz = timerGetClock(ptr_tim);
+
+    if (timerSolvePeriod(clock_hz, timerGetCounterMask(ptr_tim), rate_hz, 2u, &psc, &arr) != TIM_OK)
+    {
+        return TIM_ERR_CFG;
+    }
+
+    int status = timerClaim(ptr_tim, ptr_tim);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    ptr_tim->CR1 = TIM_CR1_ARPE;
+    ptr_tim->PSC = psc;
+    ptr_tim->ARR = arr;
+
+    if (trgo != TIM_TRGO_UPDATE)
+    {
+        const TIM_CHANNEL_LAYOUT *ptr_layout = &tim_channel_table[channel];
+        volatile uint32_t *ptr_ccmr = timerGetCcmr(ptr_tim, channel);
+
+        *ptr_ccmr = (*ptr_ccmr & ~(0xFFu << ptr_layout->ccmr_shift)) |
+                    ((((uint32_t)TIM_OC_PWM1 << TIM_CCMR1_OC1M_Pos) | TIM_CCMR1_OC1PE) << ptr_layout->ccmr_shift);
+        (&ptr_tim->CCR1)[channel] = (arr / 2u) + 1u;
+    }
+
+    (void)timerSetMaster(ptr_tim, trgo);
+
+    ptr_tim->EGR = TIM_EGR_UG;
+    ptr_tim->SR = 0u;
+
+    if (ptr_actual_mhz != NULL)
+    {
+        *ptr_actual_mhz = timerGetUpdateRate(ptr_tim);
+    }
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function starts the sample clock from a fresh period.
+ * @param   ptr_tim Pointer to timer instance.
+ * @return  None.
+ */
+void timerSampleClockStart(TIM_TypeDef *ptr_tim)
+{
+    ptr_tim->CNT = 0u;
+    ptr_tim->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief   This function stops the sample clock.
+ * @param   ptr_tim Pointer to timer instance.
+ * @return  None.
+ */
+void timerSampleClockStop(TIM_TypeDef *ptr_tim)
+{
+    ptr_tim->CR1 &= ~TIM_CR1_CEN;
+}
+
+/**
+ * @brief   This function starts DMA input capture into a ring buffer.
+ * @details The counter free-runs over its full range and every capture is
+ *          copied from CCRx by DMA, so no interrupt is taken per edge.
+ *          Supported on the channels that have a DMA request (TIM1/2/3/4/5/8).
+ * @param   ptr_cap Pointer to caller-owned capture object.
+ * @param   ptr_cfg Pointer to capture configuration.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid configuration,
+ *          TIM_ERR_BUSY if the timer is owned by someone else or the DMA
+ *          stream could not be configured, the timer is released again.
+ */
+int timerCaptureInit(TIM_CAPTURE *ptr_cap, const TIM_CAPTURE_CONFIG *ptr_cfg)
+{
+    if ((ptr_cap == NULL) || (ptr_cfg == NULL) || (ptr_cfg->ptr_buffer == NULL) ||
+        (ptr_cfg->length < 2u) || (ptr_cfg->filter > 15u) || (ptr_cfg->divider > 3u) ||
+        (ptr_cfg->channel > TIM_CHANNEL_4))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_EVENT event = (TIM_EVENT)(TIM_EVENT_CC1 + ptr_cfg->channel);
+    const TIM_DMA_REQUEST *ptr_req = timerGetDmaRequest(ptr_cfg->ptr_tim, event);
+
+    if (ptr_req == NULL)
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_TypeDef *ptr_tim = ptr_cfg->ptr_tim;
+
+    int status = timerClaim(ptr_tim, ptr_cap);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    /* A previous capture on this timer gives its stream back first */
+    timerReleaseStream(ptr_tim);
+
+    ptr_tim->CR1 = 0u;
+    ptr_tim->PSC = ptr_cfg->prescaler;
+    ptr_tim->ARR = timerGetCounterMask(ptr_tim);
+    ptr_tim->EGR = TIM_EGR_UG;
+
+    DMA_CONFIG dma_cfg = {
+        .ptr_stream  = ptr_req->ptr_stream,
+        .channel     = ptr_req->channel,
+        .dir         = DMA_DIR_P2M,
+        .psize       = DMA_SIZE_32,
+        .msize       = DMA_SIZE_32,
+        .pinc        = 0u,
+        .minc        = 1u,
+        .circular    = 1u,
+        .priority    = DMA_PRIO_HIGH,
+        .periph_addr = (uint32_t)(&ptr_tim->CCR1 + ptr_cfg->channel),
+        .mem0_addr   = (uint32_t)ptr_cfg->ptr_buffer,
+        .mem1_addr   = 0u,
+        .count       = ptr_cfg->length
+    };
+
+    if (dmaInit(&dma_cfg) != DMA_OK)
+    {
+        (void)timerDeinit(ptr_tim, ptr_cap);
+        return TIM_ERR_BUSY;
+    }
+
+    timerBindStream(ptr_tim, ptr_req->ptr_stream);
+
+    ptr_cap->ptr_tim = ptr_tim;
+    ptr_cap->ptr_stream = ptr_req->ptr_stream;
+    ptr_cap->ptr_buffer = ptr_cfg->ptr_buffer;
+    ptr_cap->length = ptr_cfg->length;
+    ptr_cap->tail = 0u;
+    ptr_cap->mask = timerGetCounterMask(ptr_tim);
+    ptr_cap->half_periods = (1UL << ptr_cfg->divider) * ((ptr_cfg->edge == TIM_IC_BOTH) ? 1u : 2u);
+
+    timerConfigIcChannel(ptr_tim, ptr_cfg->channel, 1u, ptr_cfg->edge, ptr_cfg->filter, ptr_cfg->divider);
+
+    dmaStart(ptr_req->ptr_stream);
+    ptr_tim->DIER |= (TIM_DIER_CC1DE << ptr_cfg->channel);
+    ptr_tim->CR1 |= TIM_CR1_CEN;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function reads new captures from the ring buffer.
+ * @details Entries older than one buffer length are overwritten by DMA, so
+ *          the reader must keep up with length captures per call.
+ * @param   ptr_cap Pointer to capture object.
+ * @param   ptr_out Destination for the raw counter values.
+ * @param   max Maximum number of values to read.
+ * @return  Number of values read.
+ */
+uint32_t timerCaptureRead(TIM_CAPTURE *ptr_cap, uint32_t *ptr_out, uint32_t max)
+{
+    uint32_t head = ptr_cap->length - dmaGetRemaining(ptr_cap->ptr_stream);
+    uint32_t count = 0u;
+
+    if (head >= ptr_cap->length)
+    {
+        head = 0u;
+    }
+
+    while ((ptr_cap->tail != head) && (count < max))
+    {
+        ptr_out[count++] = ptr_cap->ptr_buffer[ptr_cap->tail];
+        ptr_cap->tail = (uint16_t)((ptr_cap->tail + 1u) % ptr_cap->length);
+    }
+
+    return count;
+}
+
+/**
+ * @brief   This function computes the input frequency from the latest captures.
+ * @details Averages over the given number of capture intervals, which must
+ *          already be in the buffer and span less than one counter wrap.
+ *          Both-edge capture assumes a 50 % duty cycle.
+ * @param   ptr_cap Pointer to capture object.
+ * @param   intervals Number of intervals to average, 1 to length - 1.
+ * @param   ptr_mhz Frequency in millihertz.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid arguments,
+ *          TIM_ERR_NOSIG if the captured values are identical.
+ */
+int timerCaptureGetFrequency(const TIM_CAPTURE *ptr_cap, uint32_t intervals, uint32_t *ptr_mhz)
+{
+    if ((ptr_cap == NULL) || (ptr_mhz == NULL) || (intervals == 0u) || (intervals >= ptr_cap->length))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    uint32_t len = ptr_cap->length;
+    uint32_t head = len - dmaGetRemaining(ptr_cap->ptr_stream);
+    uint32_t last = (head + len - 1u) % len;
+    uint32_t first = (last + len - intervals) % len;
+    uint32_t span = (ptr_cap->ptr_buffer[last] - ptr_cap->ptr_buffer[first]) & ptr_cap->mask;
+
+    if (span == 0u)
+    {
+        return TIM_ERR_NOSIG;
+    }
+
+    uint64_t tick_hz = timerGetClock(ptr_cap->ptr_tim) / (ptr_cap->ptr_tim->PSC + 1u);
+    uint64_t num = tick_hz * 1000u * intervals * ptr_cap->half_periods;
+
+    *ptr_mhz = (uint32_t)(num / (2u * (uint64_t)span));
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function stops DMA input capture.
+ * @param   ptr_cap Pointer to capture object.
+ * @return  None.
+ */
+void timerCaptureStop(TIM_CAPTURE *ptr_cap)
+{
+    ptr_cap->ptr_tim->DIER &= ~(TIM_DIER_CC1DE | TIM_DIER_CC2DE | TIM_DIER_CC3DE | TIM_DIER_CC4DE);
+    ptr_cap->ptr_tim->CR1 &= ~TIM_CR1_CEN;
+    timerReleaseStream(ptr_cap->ptr_tim);
+}
+
+/**
+ * @brief   This function configures PWM input mode on TI1.
+ * @details IC1 captures the period on the rising edge and resets the counter
+ *          through slave reset mode, IC2 captures the falling edge, so CCR1
+ *          and CCR2 always hold the last period and high time without CPU.
+ * @param   ptr_tim Pointer to a timer with slave mode and two channels.
+ * @param   prescaler Counter prescaler.
+ * @param   filter IC1F/IC2F, 0 .. 15.
+ * @return  TIM_OK on success, TIM_ERR_CFG on unsupported timer, TIM_ERR_BUSY
+ *          if the timer is owned by someone else.
+ */
+int timerPwmInputInit(TIM_TypeDef *ptr_tim, uint32_t prescaler, uint32_t filter)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if ((id >= TIM_ID_MAX) || (id == TIM_ID_6) || (id == TIM_ID_7) || (id == TIM_ID_10) ||
+        (id == TIM_ID_11) || (id == TIM_ID_13) || (id == TIM_ID_14) || (filter > 15u))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    int status = timerClaim(ptr_tim, ptr_tim);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    /* URS: only counter overflow sets UIF, used to detect a lost signal */
+    ptr_tim->CR1 = TIM_CR1_URS;
+    ptr_tim->PSC = prescaler;
+    ptr_tim->ARR = timerGetCounterMask(ptr_tim);
+
+    timerConfigIcChannel(ptr_tim, TIM_CHANNEL_1, 1u, TIM_IC_RISING, filter, 0u);
+    timerConfigIcChannel(ptr_tim, TIM_CHANNEL_2, 2u, TIM_IC_FALLING, filter, 0u);
+
+    /* Trigger TI1FP1, slave reset mode */
+    ptr_tim->SMCR = (5u << TIM_SMCR_TS_Pos) | (4u << TIM_SMCR_SMS_Pos);
+
+    ptr_tim->EGR = TIM_EGR_UG;
+    ptr_tim->SR = 0u;
+    ptr_tim->CR1 |= TIM_CR1_CEN;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function returns frequency and duty cycle in PWM input mode.
+ * @param   ptr_tim Pointer to timer set up by timerPwmInputInit().
+ * @param   ptr_mhz Frequency in millihertz.
+ * @param   ptr_duty_permille High time in 1/1000 of the period.
+ * @return  TIM_OK on success, TIM_ERR_NOSIG if no edge was seen for a full
+ *          counter period.
+ */
+int timerPwmInputGet(TIM_TypeDef *ptr_tim, uint32_t *ptr_mhz, uint32_t *ptr_duty_permille)
+{
+    if ((ptr_tim->SR & TIM_SR_UIF) != 0u)
+    {
+        ptr_tim->SR = ~TIM_SR_UIF;
+        return TIM_ERR_NOSIG;
+    }
+
+    uint32_t period = ptr_tim->CCR1;
+    uint32_t high = ptr_tim->CCR2;
+
+    if (period == 0u)
+    {
+        return TIM_ERR_NOSIG;
+    }
+
+    uint64_t tick_hz = timerGetClock(ptr_tim) / (ptr_tim->PSC + 1u);
+
+    *ptr_mhz = (uint32_t)((tick_hz * 1000u) / period);
+    *ptr_duty_permille = (uint32_t)(((uint64_t)high * 1000u) / period);
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function starts a quadrature encoder with a 64-bit count.
+ * @details The counter runs in encoder mode 3 (x4) over its full range and the
+ *          update interrupt adds or removes one range on each wrap. Supported
+ *          on TIM1/2/3/4/5/8.
+ * @param   ptr_enc Pointer to caller-owned encoder object.
+ * @param   ptr_cfg Pointer to encoder configuration.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid configuration,
+ *          TIM_ERR_BUSY if the timer is owned by someone else.
+ */
+int timerEncoderInit(TIM_ENCODER *ptr_enc, const TIM_ENCODER_CONFIG *ptr_cfg)
+{
+    if ((ptr_enc == NULL) || (ptr_cfg == NULL) || (ptr_cfg->filter > 15u))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_TypeDef *ptr_tim = ptr_cfg->ptr_tim;
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if ((id > TIM_ID_5) && (id != TIM_ID_8))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    int status = timerClaim(ptr_tim, ptr_enc);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    ptr_enc->ptr_tim = ptr_tim;
+    ptr_enc->base = 0;
+    ptr_enc->range = (uint64_t)timerGetCounterMask(ptr_tim) + 1u;
+    ptr_enc->last_count = 0;
+    ptr_enc->velocity = 0;
+    ptr_enc->sample_hz = ptr_cfg->sample_hz;
+
+    /* URS keeps UG from raising UIF, so only real wraps reach the callback */
+    ptr_tim->CR1 = TIM_CR1_URS;
+    ptr_tim->PSC = 0u;
+    ptr_tim->ARR = timerGetCounterMask(ptr_tim);
+    ptr_tim->SMCR = (3u << TIM_SMCR_SMS_Pos);
+
+    timerConfigIcChannel(ptr_tim, TIM_CHANNEL_1, 1u,
+                         (ptr_cfg->invert != 0u) ? TIM_IC_FALLING : TIM_IC_RISING, ptr_cfg->filter, 0u);
+    timerConfigIcChannel(ptr_tim, TIM_CHANNEL_2, 1u, TIM_IC_RISING, ptr_cfg->filter, 0u);
+
+    ptr_tim->EGR = TIM_EGR_UG;
+    ptr_tim->CNT = 0u;
+    ptr_tim->SR = 0u;
+
+    timerRegisterCallback(ptr_tim, TIM_EVENT_UPDATE, timerEncoderWrap, ptr_enc);
+    timerEnableIrq(ptr_tim, ptr_cfg->irq_priority);
+
+    ptr_tim->CR1 |= TIM_CR1_CEN;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function returns the extended encoder position.
+ * @details A wrap that is pending but not yet handled is folded in, so the
+ *          value never jumps by one range around the wrap point.
+ * @param   ptr_enc Pointer to encoder object.
+ * @return  Position in counts.
+ */
+int64_t timerEncoderGetCount(const TIM_ENCODER *ptr_enc)
+{
+    TIM_TypeDef *ptr_tim = ptr_enc->ptr_tim;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    int64_t base = ptr_enc->base;
+    uint32_t cnt = ptr_tim->CNT;
+
+    if ((ptr_tim->SR & TIM_SR_UIF) != 0u)
+    {
+        cnt = ptr_tim->CNT;
+        base += (cnt < (ptr_enc->range / 2u)) ? (int64_t)ptr_enc->range : -(int64_t)ptr_enc->range;
+    }
+
+    __set_PRIMASK(primask);
+
+    return base + (int64_t)cnt;
+}
+
+/**
+ * @brief   This function updates the fixed-period velocity estimate.
+ * @details Call at exactly sample_hz, e.g. from the control loop interrupt.
+ * @param   ptr_enc Pointer to encoder object.
+ * @return  Position change since the previous sample.
+ */
+int32_t timerEncoderSample(TIM_ENCODER *ptr_enc)
+{
+    int64_t count = timerEncoderGetCount(ptr_enc);
+    int32_t delta = (int32_t)(count - ptr_enc->last_count);
+
+    ptr_enc->last_count = count;
+    ptr_enc->velocity = delta * (int32_t)ptr_enc->sample_hz;
+
+    return delta;
+}
+
+/**
+ * @brief   This function returns the last fixed-period velocity.
+ * @param   ptr_enc Pointer to encoder object.
+ * @return  Velocity in counts per second.
+ */
+int32_t timerEncoderGetVelocity(const TIM_ENCODER *ptr_enc)
+{
+    return ptr_enc->velocity;
+}
+
+/**
+ * @brief   This function estimates velocity from the time between edges.
+ * @details Intended for low speed, where only a few counts change per sample.
+ *          One encoder line is captured on a second timer with
+ *          timerCaptureInit(), the sign comes from the encoder direction.
+ * @param   ptr_enc Pointer to encoder object.
+ * @param   ptr_cap Pointer to capture object on the encoder signal.
+ * @param   counts_per_capture Encoder counts between two captures.
+ * @param   ptr_velocity Velocity in counts per second.
+ * @return  TIM_OK on success, TIM_ERR_NOSIG if no edge interval is available.
+ */
+int timerEncoderGetEdgeVelocity(const TIM_ENCODER *ptr_enc, const TIM_CAPTURE *ptr_cap,
+                                uint32_t counts_per_capture, int32_t *ptr_velocity)
+{
+    uint32_t mhz;
+    int status = timerCaptureGetFrequency(ptr_cap, 1u, &mhz);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    /* Capture counts half periods with both edges, scale back to captures */
+    int64_t velocity = ((int64_t)mhz * (int64_t)counts_per_capture * 2) /
+                       ((int64_t)ptr_cap->half_periods * 1000);
+
+    if ((ptr_enc->ptr_tim->CR1 & TIM_CR1_DIR) != 0u)
+    {
+        velocity = -velocity;
+    }
+
+    *ptr_velocity = (int32_t)velocity;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function configures center-aligned complementary PWM.
+ * @details Channels run PWM mode 1 with CHx/CHxN pairs separated by the
+ *          hardware dead-time generator. Outputs stay off (MOE clear) until
+ *          timerOutputsEnable(), a break input clears MOE in hardware and
+ *          forces both outputs to their inactive level. Break 2 is not
+ *          available on STM32F446, BKIN is the only fault input.
+ * @param   ptr_cfg Pointer to complementary PWM configuration.
+ * @return  TIM_OK on success, TIM_ERR_CFG if the timer is not TIM1/TIM8 or
+ *          the dead-time cannot be represented, TIM_ERR_BUSY if the timer
+ *          is owned by someone else.
+ */
+int timerCompPwmInit(const TIM_COMP_PWM_CONFIG *ptr_cfg)
+{
+    if ((ptr_cfg == NULL) || (timerIsAdvanced(ptr_cfg->ptr_tim) == 0u) ||
+        (ptr_cfg->channels == 0u) || ((ptr_cfg->channels & ~0x7u) != 0u) ||
+        (ptr_cfg->repetition > 0xFFu))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    uint32_t ckd;
+    uint32_t dtg;
+    uint32_t dts_hz = rccGetTIMCLK2();
+
+    if (timerDeadTimeEncode(dts_hz, ptr_cfg->deadtime_ns, &ckd, &dtg) != TIM_OK)
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_TypeDef *ptr_tim = ptr_cfg->ptr_tim;
+
+    int status = timerClaim(ptr_tim, ptr_cfg);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    ptr_tim->CR1 = 0u;
+    ptr_tim->BDTR = 0u;
+    ptr_tim->CCER = 0u;
+    ptr_tim->DIER = 0u;
+
+    ptr_tim->PSC = ptr_cfg->prescaler;
+    ptr_tim->ARR = ptr_cfg->period;
+    ptr_tim->RCR = ptr_cfg->repetition;
+
+    uint32_t ccmr1 = 0u;
+    uint32_t ccmr2 = 0u;
+    uint32_t ccer = 0u;
+
+    if ((ptr_cfg->channels & 0x1u) != 0u)
+    {
+        ccmr1 |= (6u << TIM_CCMR1_OC1M_Pos) | TIM_CCMR1_OC1PE;
+        ccer |= TIM_CCER_CC1E | TIM_CCER_CC1NE;
+        ptr_tim->CCR1 = 0u;
+    }
+    if ((ptr_cfg->channels & 0x2u) != 0u)
+    {
+        ccmr1 |= (6u << TIM_CCMR1_OC2M_Pos) | TIM_CCMR1_OC2PE;
+        ccer |= TIM_CCER_CC2E | TIM_CCER_CC2NE;
+        ptr_tim->CCR2 = 0u;
+    }
+    if ((ptr_cfg->channels & 0x4u) != 0u)
+    {
+        ccmr2 |= (6u << TIM_CCMR2_OC3M_Pos) | TIM_CCMR2_OC3PE;
+        ccer |= TIM_CCER_CC3E | TIM_CCER_CC3NE;
+        ptr_tim->CCR3 = 0u;
+    }
+
+    ptr_tim->CCMR1 = ccmr1;
+    ptr_tim->CCMR2 = ccmr2;
+    ptr_tim->CCER = ccer;
+
+    /* Idle level low on all outputs, OSSR/OSSI keep them driven when off */
+    uint32_t cr2 = 0u;
+    if (ptr_cfg->commutation != 0u)
+    {
+        cr2 |= TIM_CR2_CCPC;
+        if (ptr_cfg->com_source == TIM_COM_TRGI)
+        {
+            cr2 |= TIM_CR2_CCUS;
+        }
+    }
+    ptr_tim->CR2 = cr2;
+
+    uint32_t bdtr = (dtg << TIM_BDTR_DTG_Pos) | TIM_BDTR_OSSR | TIM_BDTR_OSSI;
+    if (ptr_cfg->break_input != TIM_BREAK_DISABLED)
+    {
+        bdtr |= TIM_BDTR_BKE;
+        if (ptr_cfg->break_input == TIM_BREAK_ACTIVE_HIGH)
+        {
+            bdtr |= TIM_BDTR_BKP;
+        }
+    }
+    if (ptr_cfg->auto_restart != 0u)
+    {
+        bdtr |= TIM_BDTR_AOE;
+    }
+    ptr_tim->BDTR = bdtr;
+
+    /* Center-aligned mode 1, ARR preloaded */
+    ptr_tim->CR1 = (ckd << TIM_CR1_CKD_Pos) | (1u << TIM_CR1_CMS_Pos) | TIM_CR1_ARPE;
+
+    ptr_tim->EGR = TIM_EGR_UG;
+    ptr_tim->SR = 0u;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function enables the main output and starts the counter.
+ * @details Also used to recover after a break when auto restart is disabled,
+ *          the break source must be inactive or MOE is cleared again.
+ * @param   ptr_tim Pointer to TIM1 or TIM8.
+ * @return  None.
+ */
+void timerOutputsEnable(TIM_TypeDef *ptr_tim)
+{
+    ptr_tim->SR = ~TIM_SR_BIF;
+    ptr_tim->BDTR |= TIM_BDTR_MOE;
+    ptr_tim->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief   This function forces all outputs of an advanced timer to idle level.
+ * @param   ptr_tim Pointer to TIM1 or TIM8.
+ * @return  None.
+ */
+void timerOutputsDisable(TIM_TypeDef *ptr_tim)
+{
+    ptr_tim->BDTR &= ~TIM_BDTR_MOE;
+}
+
+/**
+ * @brief   This function writes the next commutation step.
+ * @details With commutation enabled CCxE, CCxNE and OCxM are preloaded, the
+ *          values written here are applied together on the next COM event,
+ *          either from timerCommutate() or the TRGI edge.
+ * @param   ptr_tim Pointer to TIM1 or TIM8.
+ * @param   ccer CCER value for the next step.
+ * @param   ccmr1 CCMR1 value for the next step.
+ * @param   ccmr2 CCMR2 value for the next step.
+ * @return  None.
+ */
+void timerCommutationStage(TIM_TypeDef *ptr_tim, uint32_t ccer, uint32_t ccmr1, uint32_t ccmr2)
+{
+    ptr_tim->CCMR1 = ccmr1;
+    ptr_tim->CCMR2 = ccmr2;
+    ptr_tim->CCER = ccer;
+}
+
+/**
+ * @brief   This function generates a software COM event.
+ * @param   ptr_tim Pointer to TIM1 or TIM8.
+ * @return  None.
+ */
+void timerCommutate(TIM_TypeDef *ptr_tim)
+{
+    ptr_tim->EGR = TIM_EGR_COMG;
+}
+
+/**
+ * @brief   This function starts the 64-bit timestamp counter.
+ * @details TIM2 or TIM5 free-runs over 32 bits, an interrupt at the wrap and
+ *          at half range each advance an epoch counter, which lets
+ *          timerTimestampGet() extend the count without locks or retries.
+ *          Both interrupt handlers must run within half a wrap period
+ *          (about 23 s at 90 MHz), CH1 is used internally.
+ * @param   ptr_tim Pointer to TIM2 or TIM5.
+ * @param   resolution_hz Counting rate, 0 for the full timer clock.
+ * @param   irq_priority Priority of the timer interrupt.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid timer or resolution,
+ *          TIM_ERR_BUSY if the timer is owned by someone else.
+ */
+int timerTimestampInit(TIM_TypeDef *ptr_tim, uint32_t resolution_hz, uint8_t irq_priority)
+{
+    if ((ptr_tim != TIM2) && (ptr_tim != TIM5))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    uint32_t clock_hz = timerGetClock(ptr_tim);
+    uint32_t div = (resolution_hz == 0u) ? 1u : ((clock_hz + (resolution_hz / 2u)) / resolution_hz);
+
+    if ((div == 0u) || (div > 0x10000u))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    int status = timerClaim(ptr_tim, ptr_tim);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    ptr_tim->CR1 = TIM_CR1_URS;
+    ptr_tim->PSC = div - 1u;
+    ptr_tim->ARR = 0xFFFFFFFFu;
+    ptr_tim->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_OC1M | TIM_CCMR1_OC1PE);
+    ptr_tim->CCR1 = 0x80000000u;
+    ptr_tim->EGR = TIM_EGR_UG;
+    ptr_tim->CNT = 0u;
+    ptr_tim->SR = 0u;
+
+    ts_tim = ptr_tim;
+    ts_epoch = 0u;
+    ts_hz = clock_hz / div;
+
+    timerRegisterCallback(ptr_tim, TIM_EVENT_UPDATE, timerTimestampHalfWrap, NULL);
+    timerRegisterCallback(ptr_tim, TIM_EVENT_CC1, timerTimestampHalfWrap, NULL);
+    timerEnableIrq(ptr_tim, irq_priority);
+
+    ptr_tim->CR1 |= TIM_CR1_CEN;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function returns the 64-bit timestamp.
+ * @details Lock-free and safe from any priority, including with interrupts
+ *          masked. The epoch read before the counter is either current or
+ *          one half wrap behind, the counter MSB tells which.
+ * @return  Ticks since timerTimestampInit().
+ */
+uint64_t timerTimestampGet(void)
+{
+    uint32_t epoch = ts_epoch;
+    uint32_t cnt = ts_tim->CNT;
+
+    if ((epoch & 1u) != (cnt >> 31))
+    {
+        epoch++;
+    }
+
+    return ((uint64_t)(epoch >> 1) << 32) | cnt;
+}
+
+/**
+ * @brief   This function returns the timestamp counting rate.
+ * @return  Ticks per second.
+ */
+uint32_t timerTimestampGetHz(void)
+{
+    return ts_hz;
+}
+
+/**
+ * @brief   This function prepares an advanced timer for sequence playback.
+ * @details The selected channels run PWM mode 1. Each step's ARR, RCR and
+ *          CCR1..CCR4 are written by an update DMA burst, so a step of any
+ *          number of pulses costs no interrupt; only the end of the sequence
+ *          takes two update interrupts.
+ * @param   ptr_seq Pointer to caller-owned sequencer object.
+ * @param   ptr_tim Pointer to TIM1 or TIM8.
+ * @param   prescaler Counter prescaler for all steps.
+ * @param   channels Bit mask of outputs, bit 0 = CH1.
+ * @param   irq_priority Priority of the timer update and DMA interrupts.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid arguments, TIM_ERR_BUSY
+ *          if the timer is owned by someone else.
+ */
+int timerSeqInit(TIM_SEQUENCER *ptr_seq, TIM_TypeDef *ptr_tim, uint32_t prescaler,
+                 uint32_t channels, uint8_t irq_priority)
+{
+    const TIM_DMA_REQUEST *ptr_req = timerGetDmaRequest(ptr_tim, TIM_EVENT_UPDATE);
+
+    if ((ptr_seq == NULL) || (ptr_req == NULL) || (timerIsAdvanced(ptr_tim) == 0u) ||
+        (channels == 0u) || ((channels & ~0xFu) != 0u))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    int status = timerClaim(ptr_tim, ptr_seq);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    ptr_seq->ptr_tim = ptr_tim;
+    ptr_seq->ptr_stream = ptr_req->ptr_stream;
+    ptr_seq->state = TIM_SEQ_IDLE;
+    ptr_seq->callback = (fp_tim_callback)0;
+    ptr_seq->ptr_ctx = NULL;
+
+    /* URS keeps the software UG from raising a DMA request or UIF */
+    ptr_tim->CR1 = TIM_CR1_ARPE | TIM_CR1_URS;
+    ptr_tim->PSC = prescaler;
+
+    for (uint32_t ch = 0u; ch < 4u; ch++)
+    {
+        if ((channels & (1UL << ch)) != 0u)
+        {
+            TIM_CHANNEL_CONFIG cfg = {
+                .channel = (TIM_CHANNEL)ch,
+                .mode    = TIM_MODE_PWM,
+                .pulse   = 0u
+            };
+
+            timerConfigOcChannel(ptr_tim, &cfg, TIM_OC_PWM1);
+        }
+    }
+
+    ptr_tim->DCR = ((TIM_SEQ_WORDS - 1u) << TIM_DCR_DBL_Pos) |
+                   ((uint32_t)(&ptr_tim->ARR - &ptr_tim->CR1) << TIM_DCR_DBA_Pos);
+
+    timerEnableIrq(ptr_tim, irq_priority);
+    dmaEnableIrq(ptr_req->ptr_stream, irq_priority);
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function plays a table of steps once.
+ * @details The first two steps are loaded by software, the rest stream
+ *          through DMA one update ahead of playback. The last step must be
+ *          longer than the update interrupt latency, since its interrupt arms
+ *          one-pulse mode to stop the counter at its end. The table must stay
+ *          valid until the callback runs.
+ * @param   ptr_seq Pointer to sequencer object.
+ * @param   ptr_steps Table of steps.
+ * @param   count Number of steps.
+ * @param   ptr_callback Called from interrupt when the last step has ended.
+ * @param   ptr_ctx Context passed to the callback.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid arguments, TIM_ERR_BUSY
+ *          if a sequence is playing or the DMA stream is in use.
+ */
+int timerSeqPlay(TIM_SEQUENCER *ptr_seq, const TIM_SEQ_STEP *ptr_steps, uint32_t count,
+                 fp_tim_callback ptr_callback, void *ptr_ctx)
+{
+    if ((ptr_seq == NULL) || (ptr_steps == NULL) || (count == 0u) ||
+        (((count - 1u) * TIM_SEQ_WORDS) > 0xFFFFu))
+    {
+        return TIM_ERR_CFG;
+    }
+    if (ptr_seq->state != TIM_SEQ_IDLE)
+    {
+        return TIM_ERR_BUSY;
+    }
+
+    TIM_TypeDef *ptr_tim = ptr_seq->ptr_tim;
+
+    ptr_seq->callback = ptr_callback;
+    ptr_seq->ptr_ctx = ptr_ctx;
+
+    ptr_tim->CR1 &= ~(TIM_CR1_CEN | TIM_CR1_OPM);
+    ptr_tim->CNT = 0u;
+
+    /* Step 0 into the shadow registers, step 1 into preload */
+    timerSeqLoad(ptr_tim, &ptr_steps[0]);
+    ptr_tim->EGR = TIM_EGR_UG;
+    ptr_tim->SR = 0u;
+
+    if (count == 1u)
+    {
+        ptr_seq->state = TIM_SEQ_LAST;
+        timerSeqUpdate(ptr_seq);
+    }
+    else
+    {
+        timerSeqLoad(ptr_tim, &ptr_steps[1]);
+
+        if (count == 2u)
+        {
+            ptr_seq->state = TIM_SEQ_LAST;
+            timerRegisterCallback(ptr_tim, TIM_EVENT_UPDATE, timerSeqUpdate, ptr_seq);
+        }
+        else
+        {
+            DMA_CONFIG dma_cfg = {
+                .ptr_stream  = ptr_seq->ptr_stream,
+                .channel     = timerGetDmaRequest(ptr_tim, TIM_EVENT_UPDATE)->channel,
+                .dir         = DMA_DIR_M2P,
+                .psize       = DMA_SIZE_32,
+                .msize       = DMA_SIZE_32,
+                .pinc        = 0u,
+                .minc        = 1u,
+                .circular    = 0u,
+                .priority    = DMA_PRIO_HIGH,
+                .periph_addr = (uint32_t)&ptr_tim->DMAR,
+                .mem0_addr   = (uint32_t)&ptr_steps[2],
+                .mem1_addr   = 0u,
+                .count       = (uint16_t)((count - 2u) * TIM_SEQ_WORDS)
+            };
+
+            if (dmaInit(&dma_cfg) != DMA_OK)
+            {
+                return TIM_ERR_BUSY;
+            }
+
+            timerBindStream(ptr_tim, ptr_seq->ptr_stream);
+            ptr_seq->state = TIM_SEQ_DMA;
+            dmaRegisterCallback(ptr_seq->ptr_stream, DMA_EVENT_FULL, timerSeqDmaDone, ptr_seq);
+            dmaStart(ptr_seq->ptr_stream);
+            ptr_tim->DIER |= TIM_DIER_UDE;
+        }
+    }
+
+    ptr_tim->CR1 |= TIM_CR1_CEN;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function reports whether a sequence is playing.
+ * @param   ptr_seq Pointer to sequencer object.
+ * @return  1 while playing, 0 when idle.
+ */
+uint8_t timerSeqIsBusy(const TIM_SEQUENCER *ptr_seq)
+{
+    return (ptr_seq->state != TIM_SEQ_IDLE) ? 1u : 0u;
+}
+
+/**
+ * @brief   This function stops a sequence immediately without the callback.
+ * @param   ptr_seq Pointer to sequencer object.
+ * @return  None.
+ */
+void timerSeqAbort(TIM_SEQUENCER *ptr_seq)
+{
+    TIM_TypeDef *ptr_tim = ptr_seq->ptr_tim;
+
+    ptr_tim->CR1 &= ~TIM_CR1_CEN;
+    ptr_tim->DIER &= ~TIM_DIER_UDE;
+    timerRegisterCallback(ptr_tim, TIM_EVENT_UPDATE, (fp_tim_callback)0, NULL);
+    timerReleaseStream(ptr_tim);
+
+    ptr_tim->CCR1 = 0u;
+    ptr_tim->CCR2 = 0u;
+    ptr_tim->CCR3 = 0u;
+    ptr_tim->CCR4 = 0u;
+    ptr_tim->EGR = TIM_EGR_UG;
+
+    ptr_seq->state = TIM_SEQ_IDLE;
+}
+
+/**
+ * @brief   This function sets up PWM audio output from a circular buffer.
+ * @details The PWM carrier runs at the sample rate with ARR chosen for the
+ *          exact rate, the update DMA copies one sample into CCRx per period.
+ *          Resolution is log2(TIMCLK / rate), e.g. about 11.9 bits at 44.1 kHz
+ *          on TIM1/TIM8 and 10.9 bits on TIM3/TIM4 with 168 MHz SYSCLK.
+ *          Half and full callbacks run when the first or second half of the
+ *          buffer may be refilled. TIM2/TIM5 are not supported since 16-bit
+ *          DMA writes do not clear their upper CCR half.
+ * @param   ptr_audio Pointer to caller-owned audio object.
+ * @param   ptr_cfg Pointer to audio configuration.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid configuration or if the
+ *          rate leaves less than min_bits, TIM_ERR_BUSY if the timer is owned
+ *          by someone else or the DMA stream could not be configured, the
+ *          timer is released again.
+ */
+int timerAudioInit(TIM_AUDIO *ptr_audio, const TIM_AUDIO_CONFIG *ptr_cfg)
+{
+    if ((ptr_audio == NULL) || (ptr_cfg == NULL) || (ptr_cfg->ptr_buffer == NULL) ||
+        (ptr_cfg->length < 2u) || ((ptr_cfg->length & 1u) != 0u) || (ptr_cfg->sample_rate_hz == 0u) ||
+        (ptr_cfg->min_bits > 16u))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_TypeDef *ptr_tim = ptr_cfg->ptr_tim;
+    TIM_ID id = timerGetId(ptr_tim);
+    const TIM_DMA_REQUEST *ptr_req = timerGetDmaRequest(ptr_tim, TIM_EVENT_UPDATE);
+
+    if ((ptr_req == NULL) || (id == TIM_ID_2) || (id == TIM_ID_5) ||
+        ((uint32_t)ptr_cfg->channel >= tim_channel_count[id]))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    uint32_t clock_hz = timerGetClock(ptr_tim);
+    uint32_t full_scale = (clock_hz + (ptr_cfg->sample_rate_hz / 2u)) / ptr_cfg->sample_rate_hz;
+
+    if ((full_scale < 2u) || (full_scale > 0x10000u) || (full_scale < (1UL << ptr_cfg->min_bits)))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    int status = timerClaim(ptr_tim, ptr_audio);
+
+    if (status != TIM_OK)
+    {
+        return status;
+    }
+
+    /* A previous setup of this player gives its stream back first */
+    timerReleaseStream(ptr_tim);
+
+    ptr_tim->CR1 = TIM_CR1_ARPE | TIM_CR1_URS;
+    ptr_tim->PSC = 0u;
+    ptr_tim->ARR = full_scale - 1u;
+
+    TIM_CHANNEL_CONFIG ch = {
+        .channel = ptr_cfg->channel,
+        .mode    = TIM_MODE_PWM,
+        .pulse   = full_scale / 2u
+    };
+
+    timerConfigOcChannel(ptr_tim, &ch, TIM_OC_PWM1);
+    ptr_tim->EGR = TIM_EGR_UG;
+
+    DMA_CONFIG dma_cfg = {
+        .ptr_stream  = ptr_req->ptr_stream,
+        .channel     = ptr_req->channel,
+        .dir         = DMA_DIR_M2P,
+        .psize       = DMA_SIZE_16,
+        .msize       = DMA_SIZE_16,
+        .pinc        = 0u,
+        .minc        = 1u,
+        .circular    = 1u,
+        .priority    = DMA_PRIO_HIGH,
+        .periph_addr = (uint32_t)(&ptr_tim->CCR1 + ptr_cfg->channel),
+        .mem0_addr   = (uint32_t)ptr_cfg->ptr_buffer,
+        .mem1_addr   = 0u,
+        .count       = ptr_cfg->length
+    };
+
+    if (dmaInit(&dma_cfg) != DMA_OK)
+    {
+        (void)timerDeinit(ptr_tim, ptr_audio);
+        return TIM_ERR_BUSY;
+    }
+
+    timerBindStream(ptr_tim, ptr_req->ptr_stream);
+    dmaRegisterCallback(ptr_req->ptr_stream, DMA_EVENT_HALF, ptr_cfg->half_callback, ptr_cfg->ptr_ctx);
+    dmaRegisterCallback(ptr_req->ptr_stream, DMA_EVENT_FULL, ptr_cfg->full_callback, ptr_cfg->ptr_ctx);
+    dmaEnableIrq(ptr_req->ptr_stream, ptr_cfg->irq_priority);
+
+    ptr_audio->ptr_tim = ptr_tim;
+    ptr_audio->ptr_stream = ptr_req->ptr_stream;
+    ptr_audio->full_scale = full_scale;
+    ptr_audio->bits = 31u - __CLZ(full_scale);
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function starts audio playback, the buffer must be filled.
+ * @param   ptr_audio Pointer to audio object.
+ * @return  None.
+ */
+void timerAudioStart(TIM_AUDIO *ptr_audio)
+{
+    dmaStart(ptr_audio->ptr_stream);
+    ptr_audio->ptr_tim->DIER |= TIM_DIER_UDE;
+    ptr_audio->ptr_tim->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief   This function stops audio playback and parks the output at midscale.
+ * @param   ptr_audio Pointer to audio object.
+ * @return  None.
+ */
+void timerAudioStop(TIM_AUDIO *ptr_audio)
+{
+    TIM_TypeDef *ptr_tim = ptr_audio->ptr_tim;
+    uint32_t par = ptr_audio->ptr_stream->PAR;
+
+    ptr_tim->DIER &= ~TIM_DIER_UDE;
+    (void)dmaStop(ptr_audio->ptr_stream);
+
+    *(volatile uint32_t *)par = ptr_audio->full_scale / 2u;
+}
+
+/**
+ * @brief   This function stops audio output and releases timer and stream.
+ * @details The DMA stream and its half/full callbacks are released and the
+ *          timer is given up, so timerAudioInit() can claim both again.
+ * @param   ptr_audio Pointer to audio object.
+ * @return  None.
+ */
+void timerAudioDeinit(TIM_AUDIO *ptr_audio)
+{
+    timerAudioStop(ptr_audio);
+    (void)timerDeinit(ptr_audio->ptr_tim, ptr_audio);
+}
+
+/**
+ * @brief   This function converts a signed 16-bit PCM sample to a CCR value.
+ * @param   ptr_audio Pointer to audio object.
+ * @param   sample PCM sample.
+ * @return  Compare value in 0 .. full_scale - 1.
+ */
+uint16_t timerAudioFromPcm16(const TIM_AUDIO *ptr_audio, int16_t sample)
+{
+    return (uint16_t)((((uint32_t)((int32_t)sample + 32768)) * ptr_audio->full_scale) >> 16);
+}
+
+/**
+ * @brief   This function starts DMA burst updates of the compare registers.
+ * @details On every update event the timer requests a burst through DMAR that
+ *          copies the frame into ARR/RCR (optional) and CCR1..CCRn. With preload
+ *          enabled the new values take effect at the following update, so no
+ *          per-period interrupt is needed. Supported on TIM1/2/3/4/5/8, with_arr
+ *          on TIM1/TIM8 only. The timer is not claimed here, it must already
+ *          be set up by its owner, e.g. with timerInit().
+ * @param   ptr_burst Pointer to caller-owned burst object.
+ * @param   ptr_tim Pointer to an initialised timer instance.
+ * @param   channels Number of compare registers from CCR1, 1 to 4.
+ * @param   with_arr 1 to also transfer ARR and RCR at the start of the frame.
+ * @return  TIM_OK on success, TIM_ERR_CFG if unsupported, TIM_ERR_BUSY if the
+ *          DMA stream could not be configured.
+ */
+int timerBurstInit(TIM_BURST *ptr_burst, TIM_TypeDef *ptr_tim, uint32_t channels, uint8_t with_arr)
+{
+    const TIM_DMA_REQUEST *ptr_req = timerGetDmaRequest(ptr_tim, TIM_EVENT_UPDATE);
+
+    /* RCR only exists on TIM1/TIM8, elsewhere its burst slot is reserved */
+    if ((ptr_burst == NULL) || (ptr_req == NULL) || (channels < 1u) || (channels > 4u) ||
+        ((with_arr != 0u) && (timerIsAdvanced(ptr_tim) == 0u)))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    volatile uint32_t *ptr_first = (with_arr != 0u) ? &ptr_tim->ARR : &ptr_tim->CCR1;
+    uint32_t length = channels + ((with_arr != 0u) ? 2u : 0u);
+
+    /* Start from the live register values so enabling the burst is glitch-free */
+    for (uint32_t i = 0u; i < length; i++)
+    {
+        ptr_burst->frame[i] = ptr_first[i];
+    }
+
+    ptr_burst->ptr_tim = ptr_tim;
+    ptr_burst->ptr_stream = ptr_req->ptr_stream;
+    ptr_burst->length = length;
+
+    DMA_CONFIG dma_cfg = {
+        .ptr_stream  = ptr_req->ptr_stream,
+        .channel     = ptr_req->channel,
+        .dir         = DMA_DIR_M2P,
+        .psize       = DMA_SIZE_32,
+        .msize       = DMA_SIZE_32,
+        .pinc        = 0u,
+        .minc        = 1u,
+        .circular    = 1u,
+        .priority    = DMA_PRIO_HIGH,
+        .periph_addr = (uint32_t)&ptr_tim->DMAR,
+        .mem0_addr   = (uint32_t)ptr_burst->frame,
+        .mem1_addr   = 0u,
+        .count       = (uint16_t)length
+    };
+
+    if (dmaInit(&dma_cfg) != DMA_OK)
+    {
+        return TIM_ERR_BUSY;
+    }
+
+    timerBindStream(ptr_tim, ptr_req->ptr_stream);
+
+    uint32_t dba = (uint32_t)(ptr_first - &ptr_tim->CR1);
+
+    ptr_tim->DCR = ((length - 1u) << TIM_DCR_DBL_Pos) | (dba << TIM_DCR_DBA_Pos);
+    if (with_arr != 0u)
+    {
+        ptr_tim->CR1 |= TIM_CR1_ARPE;
+    }
+
+    dmaStart(ptr_req->ptr_stream);
+    ptr_tim->DIER |= TIM_DIER_UDE;
+
+    return TIM_OK;
+}
+
+/**
+ * @brief   This function publishes a new frame for the burst engine.
+ * @details Update events are held off with UDIS while the frame is copied, so
+ *          a burst never sees a half-written frame. An update falling in this
+ *          short window is skipped and the previous values stay one more period.
+ * @param   ptr_burst Pointer to burst object.
+ * @param   ptr_values New frame, same layout and length as configured.
+ * @return  TIM_OK on success, TIM_ERR_CFG on invalid arguments.
+ */
+int timerBurstCommit(TIM_BURST *ptr_burst, const uint32_t *ptr_values)
+{
+    if ((ptr_burst == NULL) || (ptr_values == NULL) || (ptr_burst->ptr_tim == NULL))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_TypeDef *ptr_tim = ptr_burst->ptr_tim;
+    DMA_Stream_TypeDef *ptr_stream = ptr_burst->ptr_stream;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    ptr_tim->CR1 |= TIM_CR1_UDIS;
+
+    /* Let a burst that started before UDIS finish */
+    while ((ptr_stream->NDTR != ptr_burst->length) && ((ptr_stream->CR & DMA_SxCR_EN) != 0u))
+    {
+        __NOP();
+    }
+
+    for (uint32_t i = 0u; i < ptr_burst->length; i++)
+    {
+        ptr_burst->frame[i] = ptr_values[i];
+    }
+
+    ptr_tim->CR1 &= ~TIM_CR1_UDIS;
+
+    __set_PRIMASK(primask);
+
+    return TIM_OK;
+}
+
+/**
+ * @brief  This function stops the burst engine, registers keep their last values.
+ * @param  ptr_burst Pointer to burst object.
+ * @return None.
+ */
+void timerBurstStop(TIM_BURST *ptr_burst)
+{
+    if ((ptr_burst == NULL) || (ptr_burst->ptr_tim == NULL))
+    {
+        return;
+    }
+
+    ptr_burst->ptr_tim->DIER &= ~TIM_DIER_UDE;
+    timerReleaseStream(ptr_burst->ptr_tim);
+    ptr_burst->ptr_tim->DCR = 0u;
+}
 
 /**
- * @section Public Function Definations.
+ * @section Private Function Definations.
  */
 
 /**
- * @brief   This function initializes timer as per provided configuration.
- * @param   ptr_cfg Pointer to timer configuration structure.
- * @return  None.
+ * @brief   This function returns the DMA request mapping of a timer event.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   event TIM_EVENT_UPDATE or TIM_EVENT_CC1..CC4.
+ * @return  Pointer to the mapping, NULL if the timer has no such request.
  */
-void timerInit(const TIM_CONFIG *ptr_cfg)
+static const TIM_DMA_REQUEST *timerGetDmaRequest(const TIM_TypeDef *ptr_tim, TIM_EVENT event)
 {
-    if (ptr_cfg->ptr_tim == TIM1) {
-        rccEnableAPB2(RCC_APB2ENR_TIM1EN);
-    } 
-    else if (ptr_cfg->ptr_tim == TIM2) {
-        rccEnableAPB1(RCC_APB1ENR_TIM2EN);
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if ((id >= TIM_ID_MAX) || (event > TIM_EVENT_CC4) || (tim_dma_table[id][event].ptr_stream == NULL))
+    {
+        return NULL;
     }
-    else if (ptr_cfg->ptr_tim == TIM3) {
-        rccEnableAPB1(RCC_APB1ENR_TIM3EN);
+
+    return &tim_dma_table[id][event];
+}
+
+/**
+ * @brief   This function checks for a timer with break and dead-time logic.
+ * @param   ptr_tim Pointer to timer instance.
+ * @return  1 for TIM1/TIM8, 0 otherwise.
+ */
+static uint8_t timerIsAdvanced(const TIM_TypeDef *ptr_tim)
+{
+    return ((ptr_tim == TIM1) || (ptr_tim == TIM8)) ? 1u : 0u;
+}
+
+/**
+ * @brief   This function returns the counter wrap mask of a timer.
+ * @param   ptr_tim Pointer to timer instance.
+ * @return  0xFFFFFFFF for TIM2/TIM5, 0xFFFF otherwise.
+ */
+static uint32_t timerGetCounterMask(const TIM_TypeDef *ptr_tim)
+{
+    return ((ptr_tim == TIM2) || (ptr_tim == TIM5)) ? 0xFFFFFFFFu : 0xFFFFu;
+}
+
+/**
+ * @brief   This function configures one channel as an input.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   channel Channel to configure.
+ * @param   ccs CCxS value, 1 direct TIx, 2 indirect, 3 TRC.
+ * @param   edge Active edge.
+ * @param   filter ICxF, 0 .. 15.
+ * @param   divider ICxPSC, 0 .. 3.
+ * @return  None.
+ */
+static void timerConfigIcChannel(TIM_TypeDef *ptr_tim, TIM_CHANNEL channel, uint32_t ccs,
+                                 TIM_IC_EDGE edge, uint32_t filter, uint32_t divider)
+{
+    const TIM_CHANNEL_LAYOUT *ptr_layout = &tim_channel_table[channel];
+    volatile uint32_t *ptr_ccmr = timerGetCcmr(ptr_tim, channel);
+    uint32_t ccer = TIM_CCER_CC1E;
+
+    if (edge == TIM_IC_FALLING)
+    {
+        ccer |= TIM_CCER_CC1P;
     }
-    else if (ptr_cfg->ptr_tim == TIM4) {
-        rccEnableAPB1(RCC_APB1ENR_TIM4EN);
+    else if (edge == TIM_IC_BOTH)
+    {
+        ccer |= TIM_CCER_CC1P | TIM_CCER_CC1NP;
     }
-    else if (ptr_cfg->ptr_tim == TIM5) {
-        rccEnableAPB1(RCC_APB1ENR_TIM5EN);
+
+    ptr_tim->CCER &= ~((TIM_CCER_CC1E | TIM_CCER_CC1P | TIM_CCER_CC1NP) << ptr_layout->ccer_shift);
+
+    *ptr_ccmr = (*ptr_ccmr & ~(0xFFu << ptr_layout->ccmr_shift)) |
+                ((ccs | (divider << TIM_CCMR1_IC1PSC_Pos) | (filter << TIM_CCMR1_IC1F_Pos)) << ptr_layout->ccmr_shift);
+
+    ptr_tim->CCER |= (ccer << ptr_layout->ccer_shift);
+}
+
+/**
+ * @brief   This function configures one channel as a compare output.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   ptr_ch Pointer to channel configuration.
+ * @param   oc_mode OCxM value.
+ * @return  None.
+ */
+static void timerConfigOcChannel(TIM_TypeDef *ptr_tim, const TIM_CHANNEL_CONFIG *ptr_ch, TIM_OC_MODE oc_mode)
+{
+    const TIM_CHANNEL_LAYOUT *ptr_layout = &tim_channel_table[ptr_ch->channel];
+    volatile uint32_t *ptr_ccmr = timerGetCcmr(ptr_tim, ptr_ch->channel);
+    uint32_t ccer = TIM_CCER_CC1E;
+
+    if (ptr_ch->polarity != 0u)
+    {
+        ccer |= TIM_CCER_CC1P;
     }
-    else if (ptr_cfg->ptr_tim == TIM8) {
-        rccEnableAPB2(RCC_APB2ENR_TIM8EN);
+
+    ptr_tim->CCER &= ~((TIM_CCER_CC1E | TIM_CCER_CC1P) << ptr_layout->ccer_shift);
+
+    *ptr_ccmr = (*ptr_ccmr & ~(0xFFu << ptr_layout->ccmr_shift)) |
+                ((((uint32_t)oc_mode << TIM_CCMR1_OC1M_Pos) | TIM_CCMR1_OC1PE) << ptr_layout->ccmr_shift);
+
+    (&ptr_tim->CCR1)[ptr_ch->channel] = ptr_ch->pulse;
+
+    /* Outputs of TIM1/TIM8 stay off until the main output is enabled */
+    if (timerIsAdvanced(ptr_tim) != 0u)
+    {
+        ptr_tim->CR2 = (ptr_tim->CR2 & ~(1UL << ptr_layout->ois_shift)) |
+                       ((ptr_ch->idle_high != 0u) ? (1UL << ptr_layout->ois_shift) : 0u);
+        ptr_tim->BDTR |= TIM_BDTR_MOE;
     }
-    else if (ptr_cfg->ptr_tim == TIM9) {
-        rccEnableAPB2(RCC_APB2ENR_TIM9EN);
+
+    ptr_tim->CCER |= (ccer << ptr_layout->ccer_shift);
+}
+
+/**
+ * @brief   This function finds the ITRx input of a slave fed by a master.
+ * @param   ptr_slave Pointer to slave timer.
+ * @param   ptr_master Pointer to master timer.
+ * @return  ITR index 0 .. 3, -1 if not connected.
+ */
+static int timerGetItr(const TIM_TypeDef *ptr_slave, const TIM_TypeDef *ptr_master)
+{
+    TIM_ID slave = timerGetId(ptr_slave);
+    TIM_ID master = timerGetId(ptr_master);
+
+    if ((slave >= TIM_ID_MAX) || (master >= TIM_ID_MAX))
+    {
+        return -1;
     }
-    else if (ptr_cfg->ptr_tim == TIM10) {
-        rccEnableAPB2(RCC_APB2ENR_TIM10EN);
+
+    for (int itr = 0; itr < 4; itr++)
+    {
+        if (tim_itr_table[slave][itr] == master)
+        {
+            return itr;
+        }
     }
-    else if (ptr_cfg->ptr_tim == TIM11) {
-        rccEnableAPB2(RCC_APB2ENR_TIM11EN);
+
+    return -1;
+}
+
+/**
+ * @brief   This function refreshes the cached clock of all owned timers.
+ * @return  None.
+ */
+static void timerClockChanged(void)
+{
+    for (uint32_t id = 0u; id < (uint32_t)TIM_ID_MAX; id++)
+    {
+        if (tim_handle_table[id].state != TIM_STATE_FREE)
+        {
+            tim_handle_table[id].clock_hz = timerGetClock(tim_handle_table[id].ptr_tim);
+        }
     }
-    
-    ptr_cfg->ptr_tim->CR1 = 0u;
-    ptr_cfg->ptr_tim->CR2 = 0u;
-    ptr_cfg->ptr_tim->DIER = 0u;
+}
 
-    switch (ptr_cfg->mode) {
-        case TIM_MODE_BASIC:
-            timerConfigBase(ptr_cfg);
-            break;
+/**
+ * @brief   This function advances the timestamp epoch.
+ * @param   ptr_ctx Unused.
+ * @return  None.
+ */
+static void timerTimestampHalfWrap(void *ptr_ctx)
+{
+    (void)ptr_ctx;
+    ts_epoch++;
+}
 
-        case TIM_MODE_PWM:
-            timerConfigPwm(ptr_cfg);
-            break;
+/**
+ * @brief   This function writes one sequencer step into the preload registers.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   ptr_step Pointer to step.
+ * @return  None.
+ */
+static void timerSeqLoad(TIM_TypeDef *ptr_tim, const TIM_SEQ_STEP *ptr_step)
+{
+    ptr_tim->ARR = ptr_step->period;
+    ptr_tim->RCR = ptr_step->repeat;
+    ptr_tim->CCR1 = ptr_step->duty[0];
+    ptr_tim->CCR2 = ptr_step->duty[1];
+    ptr_tim->CCR3 = ptr_step->duty[2];
+    ptr_tim->CCR4 = ptr_step->duty[3];
+}
 
-        case TIM_MODE_INPUT_CAPTURE:
-            timerConfigInputCapture(ptr_cfg);
-            break;
+/**
+ * @brief   This function handles the DMA transfer of the last step.
+ * @details The last step now sits in preload and becomes active at the next
+ *          update, which is where the stop logic takes over.
+ * @param   ptr_ctx Pointer to sequencer object.
+ * @return  None.
+ */
+static void timerSeqDmaDone(void *ptr_ctx)
+{
+    TIM_SEQUENCER *ptr_seq = (TIM_SEQUENCER *)ptr_ctx;
 
-        case TIM_MODE_OUTPUT_COMPARE:
-            timerConfigOutputCompare(ptr_cfg);
-            break;
+    /* Release the stream between sequences, the next play claims it again */
+    ptr_seq->ptr_tim->DIER &= ~TIM_DIER_UDE;
+    timerReleaseStream(ptr_seq->ptr_tim);
 
-        case TIM_MODE_ENCODER:
-            timerConfigEncoder(ptr_cfg);
-            break;
+    ptr_seq->state = TIM_SEQ_LAST;
+    ptr_seq->ptr_tim->SR = ~TIM_SR_UIF;
+    timerRegisterCallback(ptr_seq->ptr_tim, TIM_EVENT_UPDATE, timerSeqUpdate, ptr_seq);
+}
 
-        default:
-            break;
+/**
+ * @brief   This function ends a sequence over its last two updates.
+ * @details When the last step becomes active, one-pulse mode is armed and
+ *          zero compare values are preloaded, so the counter stops at the end
+ *          of the step with all outputs inactive. The following update
+ *          completes the sequence.
+ * @param   ptr_ctx Pointer to sequencer object.
+ * @return  None.
+ */
+static void timerSeqUpdate(void *ptr_ctx)
+{
+    TIM_SEQUENCER *ptr_seq = (TIM_SEQUENCER *)ptr_ctx;
+    TIM_TypeDef *ptr_tim = ptr_seq->ptr_tim;
+
+    if (ptr_seq->state == TIM_SEQ_LAST)
+    {
+        ptr_tim->CR1 |= TIM_CR1_OPM;
+        ptr_tim->CCR1 = 0u;
+        ptr_tim->CCR2 = 0u;
+        ptr_tim->CCR3 = 0u;
+        ptr_tim->CCR4 = 0u;
+
+        ptr_seq->state = TIM_SEQ_STOPPING;
+        timerRegisterCallback(ptr_tim, TIM_EVENT_UPDATE, timerSeqUpdate, ptr_seq);
+    }
+    else if (ptr_seq->state == TIM_SEQ_STOPPING)
+    {
+        timerRegisterCallback(ptr_tim, TIM_EVENT_UPDATE, (fp_tim_callback)0, NULL);
+        ptr_tim->CR1 &= ~TIM_CR1_OPM;
+        ptr_seq->state = TIM_SEQ_IDLE;
+
+        if (ptr_seq->callback != (fp_tim_callback)0)
+        {
+            ptr_seq->callback(ptr_seq->ptr_ctx);
+        }
     }
 }
 
 /**
- * @brief   This function starts the timer counter.
- * @param   ptr_cfg Pointer to timer configuration structure.
- * @return  None.
+ * @brief   This function returns the mode register holding a channel.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   channel Channel.
+ * @return  Pointer to CCMR1 or CCMR2.
  */
-void timerStart(const TIM_CONFIG *ptr_cfg)
+static volatile uint32_t *timerGetCcmr(TIM_TypeDef *ptr_tim, TIM_CHANNEL channel)
 {
-    ptr_cfg->ptr_tim->CR1 |= TIM_CR1_CEN;
+    return (tim_channel_table[channel].ccmr == 0u) ? &ptr_tim->CCMR1 : &ptr_tim->CCMR2;
 }
 
 /**
- * @brief   This function stops the timer counter.
- * @param   ptr_cfg Pointer to timer configuration structure.
+ * @brief   This function accounts for one encoder counter wrap.
+ * @details The direction is taken from where the counter is now rather than
+ *          CR1.DIR, which may already have reversed when the interrupt runs.
+ * @param   ptr_ctx Pointer to encoder object.
  * @return  None.
  */
-void timerStop(const TIM_CONFIG *ptr_cfg)
+static void timerEncoderWrap(void *ptr_ctx)
 {
-    ptr_cfg->ptr_tim->CR1 &= ~TIM_CR1_CEN;
+    TIM_ENCODER *ptr_enc = (TIM_ENCODER *)ptr_ctx;
+
+    if (ptr_enc->ptr_tim->CNT < (ptr_enc->range / 2u))
+    {
+        ptr_enc->base += (int64_t)ptr_enc->range;
+    }
+    else
+    {
+        ptr_enc->base -= (int64_t)ptr_enc->range;
+    }
 }
 
 /**
- * @brief   This function handles timer update interrupt events.
- * @param   ptr_tim Pointer to timer instance that generated interrupt.
- * @return  None.
+ * @brief   This function converts a dead-time to CKD and BDTR.DTG fields.
+ * @details The value is rounded up so the inserted dead-time is never shorter
+ *          than requested. CKD is only raised when DTG cannot reach the time
+ *          at tDTS = tCK_INT, since it also slows the input filters.
+ * @param   timclk_hz Timer kernel clock.
+ * @param   ns Dead-time in nanoseconds.
+ * @param   ptr_ckd CR1.CKD value.
+ * @param   ptr_dtg BDTR.DTG value.
+ * @return  TIM_OK on success, TIM_ERR_CFG if out of range.
  */
-void timerHandleIrq(TIM_TypeDef *ptr_tim)
+static int timerDeadTimeEncode(uint32_t timclk_hz, uint32_t ns, uint32_t *ptr_ckd, uint32_t *ptr_dtg)
 {
-    /* Check update interrupt flag */
-    if ((ptr_tim->SR & TIM_SR_UIF) != 0u) 
+    for (uint32_t ckd = 0u; ckd < 3u; ckd++)
     {
-        /* Clear interrupt flag */
-        ptr_tim->SR &= ~TIM_SR_UIF;
+        uint32_t dts_hz = timclk_hz >> ckd;
+        uint64_t ticks = (((uint64_t)ns * dts_hz) + 999999999u) / 1000000000u;
 
-        /* ---- PWM Pulse Auto Update Logic ---- */
-        uint32_t arr_val = ptr_tim->ARR;
-        uint32_t next = ptr_tim->CCR1 + 1u;
+        *ptr_ckd = ckd;
 
-        if (next >= arr_val) 
+        if (ticks <= 127u)
+        {
+            *ptr_dtg = (uint32_t)ticks;
+            return TIM_OK;
+        }
+        if (ticks <= (2u * 127u))
+        {
+            *ptr_dtg = 0x80u | (uint32_t)(((ticks + 1u) / 2u) - 64u);
+            return TIM_OK;
+        }
+        if (ticks <= (8u * 63u))
         {
-            next = 0u;
+            *ptr_dtg = 0xC0u | (uint32_t)(((ticks + 7u) / 8u) - 32u);
+            return TIM_OK;
         }
+        if (ticks <= (16u * 63u))
+        {
+            *ptr_dtg = 0xE0u | (uint32_t)(((ticks + 15u) / 16u) - 32u);
+            return TIM_OK;
+        }
+    }
+
+    return TIM_ERR_CFG;
+}
+
+/**
+ * @brief   This function claims a timer for an owner.
+ * @details The first claim fills the handle and enables the bus clock, a
+ *          repeated claim by the same owner only reinitialises.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   ptr_owner Non-NULL tag identifying the owner.
+ * @return  TIM_OK if the owner holds the timer, TIM_ERR_CFG if the timer or
+ *          tag is invalid, TIM_ERR_BUSY if someone else owns it.
+ */
+static int timerClaim(TIM_TypeDef *ptr_tim, const void *ptr_owner)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if ((id >= TIM_ID_MAX) || (ptr_owner == NULL))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    TIM_HANDLE *ptr_handle = &tim_handle_table[id];
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (ptr_handle->state != TIM_STATE_FREE)
+    {
+        int status = (ptr_handle->ptr_owner == ptr_owner) ? TIM_OK : TIM_ERR_BUSY;
 
-        ptr_tim->CCR1 = next;
+        __set_PRIMASK(primask);
+        return status;
     }
+
+    ptr_handle->state = TIM_STATE_OWNED;
+    ptr_handle->ptr_owner = ptr_owner;
+
+    __set_PRIMASK(primask);
+
+    ptr_handle->ptr_tim = ptr_tim;
+    ptr_handle->clock_hz = timerGetClock(ptr_tim);
+    ptr_handle->caps = tim_caps_table[id];
+    ptr_handle->channels = tim_channel_count[id];
+
+    rccPeriphClockEnable(tim_periph_table[id]);
+    (void)rccRegisterClockCallback(timerClockChanged);
+
+    return TIM_OK;
 }
 
 /**
- * @section Private Function Definations.
+ * @brief   This function checks who owns a timer.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   ptr_owner Owner tag.
+ * @return  1 if ptr_owner holds the timer, 0 otherwise.
  */
+static uint8_t timerIsOwner(const TIM_TypeDef *ptr_tim, const void *ptr_owner)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+
+    return ((id < TIM_ID_MAX) && (tim_handle_table[id].state != TIM_STATE_FREE) &&
+            (tim_handle_table[id].ptr_owner == ptr_owner)) ? 1u : 0u;
+}
 
 /**
- * @brief   This function configures timer in basic timer mode.
- * @param   ptr_cfg Pointer to timer configuration structure.
+ * @brief   This function records the DMA stream a service holds on a timer.
+ * @param   ptr_tim Pointer to timer instance.
+ * @param   ptr_stream Stream claimed with dmaInit().
  * @return  None.
  */
-static void timerConfigBase(const TIM_CONFIG *ptr_cfg)
+static void timerBindStream(const TIM_TypeDef *ptr_tim, DMA_Stream_TypeDef *ptr_stream)
 {
-    ptr_cfg->ptr_tim->PSC = ptr_cfg->prescaler;
-    ptr_cfg->ptr_tim->ARR = ptr_cfg->period;
-    ptr_cfg->ptr_tim->EGR = TIM_EGR_UG;
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if (id < TIM_ID_MAX)
+    {
+        tim_handle_table[id].ptr_stream = ptr_stream;
+    }
 }
 
 /**
- * @brief   This function configures timer in PWM mode.
+ * @brief   This function stops and releases the DMA stream held on a timer.
+ * @details dmaDeinit() also drops the stream callbacks. No-op if none is held.
+ * @param   ptr_tim Pointer to timer instance.
+ * @return  None.
+ */
+static void timerReleaseStream(const TIM_TypeDef *ptr_tim)
+{
+    TIM_ID id = timerGetId(ptr_tim);
+
+    if ((id < TIM_ID_MAX) && (tim_handle_table[id].ptr_stream != NULL))
+    {
+        dmaDeinit(tim_handle_table[id].ptr_stream);
+        tim_handle_table[id].ptr_stream = NULL;
+    }
+}
+
+/**
+ * @brief   This function writes a timer configuration to the registers.
  * @param   ptr_cfg Pointer to timer configuration structure.
  * @return  None.
  */
-static void timerConfigPwm(const TIM_CONFIG *ptr_cfg)
+static void timerApplyConfig(const TIM_CONFIG *ptr_cfg)
 {
-    ptr_cfg->ptr_tim->PSC = ptr_cfg->prescaler;
-    ptr_cfg->ptr_tim->ARR = ptr_cfg->period;
+    ptr_cfg->ptr_tim->CR1 = 0u;
+    ptr_cfg->ptr_tim->CR2 = 0u;
+    ptr_cfg->ptr_tim->DIER = 0u;
+
+    switch (ptr_cfg->mode) {
+        case TIM_MODE_BASIC:
+            timerConfigBase(ptr_cfg);
+            break;
 
-    switch (ptr_cfg->channel) {
-        case TIM_CHANNEL_1:
-            ptr_cfg->ptr_tim->CCMR1 &= ~TIM_CCMR1_OC1M;
-            ptr_cfg->ptr_tim->CCMR1 |= (6u << TIM_CCMR1_OC1M_Pos);
-            ptr_cfg->ptr_tim->CCMR1 |= TIM_CCMR1_OC1PE;
-            ptr_cfg->ptr_tim->CCR1 = ptr_cfg->pulse;
-            ptr_cfg->ptr_tim->CCER |= TIM_CCER_CC1E;
+        case TIM_MODE_PWM:
+            timerConfigPwm(ptr_cfg);
             break;
 
-        case TIM_CHANNEL_2:
-            ptr_cfg->ptr_tim->CCMR1 &= ~TIM_CCMR1_OC2M;
-            ptr_cfg->ptr_tim->CCMR1 |= (6u << TIM_CCMR1_OC2M_Pos);
-            ptr_cfg->ptr_tim->CCMR1 |= TIM_CCMR1_OC2PE;
-            ptr_cfg->ptr_tim->CCR2 = ptr_cfg->pulse;
-            ptr_cfg->ptr_tim->CCER |= TIM_CCER_CC2E;
+        case TIM_MODE_INPUT_CAPTURE:
+            timerConfigInputCapture(ptr_cfg);
             break;
 
-        case TIM_CHANNEL_3:
-            ptr_cfg->ptr_tim->CCMR2 &= ~TIM_CCMR2_OC3M;
-            ptr_cfg->ptr_tim->CCMR2 |= (6u << TIM_CCMR2_OC3M_Pos);
-            ptr_cfg->ptr_tim->CCMR2 |= TIM_CCMR2_OC3PE;
-            ptr_cfg->ptr_tim->CCR3 = ptr_cfg->pulse;
-            ptr_cfg->ptr_tim->CCER |= TIM_CCER_CC3E;
+        case TIM_MODE_OUTPUT_COMPARE:
+            timerConfigOutputCompare(ptr_cfg);
             break;
 
-        case TIM_CHANNEL_4:
-            ptr_cfg->ptr_tim->CCMR2 &= ~TIM_CCMR2_OC4M;
-            ptr_cfg->ptr_tim->CCMR2 |= (6u << TIM_CCMR2_OC4M_Pos);
-            ptr_cfg->ptr_tim->CCMR2 |= TIM_CCMR2_OC4PE;
-            ptr_cfg->ptr_tim->CCR4 = ptr_cfg->pulse;
-            ptr_cfg->ptr_tim->CCER |= TIM_CCER_CC4E;
+        case TIM_MODE_ENCODER:
+            timerConfigEncoder(ptr_cfg);
             break;
 
         default:
             break;
     }
+}
+
+/**
+ * @brief   This function configures timer in basic timer mode.
+ * @param   ptr_cfg Pointer to timer configuration structure.
+ * @return  None.
+ */
+static void timerConfigBase(const TIM_CONFIG *ptr_cfg)
+{
+    ptr_cfg->ptr_tim->PSC = ptr_cfg->prescaler;
+    ptr_cfg->ptr_tim->ARR = ptr_cfg->period;
+    ptr_cfg->ptr_tim->CR1 |= TIM_CR1_ARPE;
+    ptr_cfg->ptr_tim->EGR = TIM_EGR_UG;
+}
+
+/**
+ * @brief   This function configures timer in PWM mode.
+ * @param   ptr_cfg Pointer to timer configuration structure.
+ * @return  None.
+ */
+static void timerConfigPwm(const TIM_CONFIG *ptr_cfg)
+{
+    TIM_CHANNEL_CONFIG ch = {
+        .channel  = ptr_cfg->channel,
+        .mode     = TIM_MODE_PWM,
+        .pulse    = ptr_cfg->pulse,
+        .polarity = ptr_cfg->polarity
+    };
+
+    ptr_cfg->ptr_tim->PSC = ptr_cfg->prescaler;
+    ptr_cfg->ptr_tim->ARR = ptr_cfg->period;
+    ptr_cfg->ptr_tim->CR1 |= TIM_CR1_ARPE;
+
+    (void)timerConfigChannel(ptr_cfg->ptr_tim, &ch);
 
     ptr_cfg->ptr_tim->EGR = TIM_EGR_UG;
 }
@@ -205,55 +2854,41 @@ static void timerConfigPwm(const TIM_CONFIG *ptr_cfg)
  */
 static void timerConfigInputCapture(const TIM_CONFIG *ptr_cfg)
 {
+    TIM_CHANNEL_CONFIG ch = {
+        .channel = ptr_cfg->channel,
+        .mode    = TIM_MODE_INPUT_CAPTURE,
+        .edge    = (ptr_cfg->polarity != 0u) ? TIM_IC_FALLING : TIM_IC_RISING
+    };
+
     ptr_cfg->ptr_tim->PSC = ptr_cfg->prescaler;
     ptr_cfg->ptr_tim->ARR = ptr_cfg->period;
 
-    switch (ptr_cfg->channel) {
-        case TIM_CHANNEL_1:
-            ptr_cfg->ptr_tim->CCMR1 &= ~TIM_CCMR1_CC1S;
-            ptr_cfg->ptr_tim->CCMR1 |= 1u;
-            ptr_cfg->ptr_tim->CCER |= TIM_CCER_CC1E;
-            break;
-
-        case TIM_CHANNEL_2:
-            ptr_cfg->ptr_tim->CCMR1 &= ~TIM_CCMR1_CC2S;
-            ptr_cfg->ptr_tim->CCMR1 |= (1u << TIM_CCMR1_CC2S_Pos);
-            ptr_cfg->ptr_tim->CCER |= TIM_CCER_CC2E;
-            break;
-
-        default:
-            break;
-    }
+    (void)timerConfigChannel(ptr_cfg->ptr_tim, &ch);
 
     ptr_cfg->ptr_tim->EGR = TIM_EGR_UG;
 }
 
 /**
  * @brief   This function configures timer in output compare mode.
+ * @details The output toggles on every match of CCRx.
  * @param   ptr_cfg Pointer to timer configuration structure.
  * @return  None.
  */
 static void timerConfigOutputCompare(const TIM_CONFIG *ptr_cfg)
 {
+    TIM_CHANNEL_CONFIG ch = {
+        .channel  = ptr_cfg->channel,
+        .mode     = TIM_MODE_OUTPUT_COMPARE,
+        .oc_mode  = TIM_OC_TOGGLE,
+        .pulse    = ptr_cfg->pulse,
+        .polarity = ptr_cfg->polarity
+    };
+
     ptr_cfg->ptr_tim->PSC = ptr_cfg->prescaler;
     ptr_cfg->ptr_tim->ARR = ptr_cfg->period;
+    ptr_cfg->ptr_tim->CR1 |= TIM_CR1_ARPE;
 
-    switch (ptr_cfg->channel) {
-        case TIM_CHANNEL_1:
-            ptr_cfg->ptr_tim->CCR1 = ptr_cfg->pulse;
-            ptr_cfg->ptr_tim->CCMR1 |= TIM_CCMR1_OC1PE;
-            ptr_cfg->ptr_tim->CCER |= TIM_CCER_CC1E;
-            break;
-
-        case TIM_CHANNEL_2:
-            ptr_cfg->ptr_tim->CCR2 = ptr_cfg->pulse;
-            ptr_cfg->ptr_tim->CCMR1 |= TIM_CCMR1_OC2PE;
-            ptr_cfg->ptr_tim->CCER |= TIM_CCER_CC2E;
-            break;
-
-        default:
-            break;
-    }
+    (void)timerConfigChannel(ptr_cfg->ptr_tim, &ch);
 
     ptr_cfg->ptr_tim->EGR = TIM_EGR_UG;
 }
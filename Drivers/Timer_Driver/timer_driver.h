@@ -7,9 +7,28 @@
 #ifndef TIMER_DRIVER_H
 #define TIMER_DRIVER_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include "stm32f446xx.h"
 
+/**
+ * @section Public Macro Definations.
+ */
+#define TIM_OK               0
+#define TIM_ERR_CFG         -1
+#define TIM_ERR_BUSY        -2
+#define TIM_ERR_NOSIG       -3
+
+#define TIM_BURST_MAX_WORDS  6U
+
+/* Timer capability flags */
+#define TIM_CAP_32BIT        (1U << 0)
+#define TIM_CAP_ADVANCED     (1U << 1)
+#define TIM_CAP_MASTER       (1U << 2)
+#define TIM_CAP_SLAVE        (1U << 3)
+#define TIM_CAP_ENCODER      (1U << 4)
+#define TIM_CAP_DMA          (1U << 5)
+
 /**
  * @section Public Type Declaration.
  */
@@ -28,6 +47,104 @@ typedef enum {
     TIM_CHANNEL_4
 } TIM_CHANNEL;
 
+/* Values match the OCxM field */
+typedef enum {
+    TIM_OC_FROZEN = 0u,
+    TIM_OC_ACTIVE,
+    TIM_OC_INACTIVE,
+    TIM_OC_TOGGLE,
+    TIM_OC_FORCE_INACTIVE,
+    TIM_OC_FORCE_ACTIVE,
+    TIM_OC_PWM1,
+    TIM_OC_PWM2
+} TIM_OC_MODE;
+
+typedef enum {
+    TIM_ID_1 = 0u,
+    TIM_ID_2,
+    TIM_ID_3,
+    TIM_ID_4,
+    TIM_ID_5,
+    TIM_ID_6,
+    TIM_ID_7,
+    TIM_ID_8,
+    TIM_ID_9,
+    TIM_ID_10,
+    TIM_ID_11,
+    TIM_ID_12,
+    TIM_ID_13,
+    TIM_ID_14,
+    TIM_ID_MAX
+} TIM_ID;
+
+/* Event number equals its bit position in SR and DIER */
+typedef enum {
+    TIM_EVENT_UPDATE = 0u,
+    TIM_EVENT_CC1,
+    TIM_EVENT_CC2,
+    TIM_EVENT_CC3,
+    TIM_EVENT_CC4,
+    TIM_EVENT_COM,
+    TIM_EVENT_TRIGGER,
+    TIM_EVENT_BREAK,
+    TIM_EVENT_MAX
+} TIM_EVENT;
+
+/* Values match CR2.MMS */
+typedef enum {
+    TIM_TRGO_RESET = 0u,
+    TIM_TRGO_ENABLE,
+    TIM_TRGO_UPDATE,
+    TIM_TRGO_CC1,
+    TIM_TRGO_OC1REF,
+    TIM_TRGO_OC2REF,
+    TIM_TRGO_OC3REF,
+    TIM_TRGO_OC4REF
+} TIM_TRGO;
+
+/* Values match SMCR.SMS */
+typedef enum {
+    TIM_SLAVE_DISABLED = 0u,
+    TIM_SLAVE_RESET    = 4u,
+    TIM_SLAVE_GATED    = 5u,
+    TIM_SLAVE_TRIGGER  = 6u,
+    TIM_SLAVE_EXT_CLOCK = 7u
+} TIM_SLAVE_MODE;
+
+/* Values match SMCR.TS */
+typedef enum {
+    TIM_OPM_TRIG_TI1 = 5u,
+    TIM_OPM_TRIG_TI2 = 6u,
+    TIM_OPM_TRIG_ETR = 7u
+} TIM_OPM_TRIGGER;
+
+typedef enum {
+    TIM_IC_RISING = 0u,
+    TIM_IC_FALLING,
+    TIM_IC_BOTH
+} TIM_IC_EDGE;
+
+typedef enum {
+    TIM_BREAK_DISABLED = 0u,
+    TIM_BREAK_ACTIVE_LOW,
+    TIM_BREAK_ACTIVE_HIGH
+} TIM_BREAK;
+
+typedef enum {
+    TIM_COM_SOFTWARE = 0u,   /* COM generated by timerCommutate() */
+    TIM_COM_TRGI             /* COM generated on TRGI rising edge, e.g. hall timer */
+} TIM_COM_SOURCE;
+
+/**
+ * @brief Opaque timer handle, one per timer instance.
+ */
+typedef struct TIM_HANDLE TIM_HANDLE;
+
+/**
+ * @brief Callback function pointer for timer events.
+ */
+typedef void (*fp_tim_callback)(void *ptr_ctx);
+
 typedef struct {
     TIM_TypeDef *ptr_tim;
     uint32_t clock_hz;
@@ -39,12 +156,209 @@ typedef struct {
     uint32_t polarity;
 } TIM_CONFIG;
 
+/* Center-aligned complementary PWM on TIM1/TIM8, channels 1..3 */
+typedef struct {
+    TIM_TypeDef *ptr_tim;
+    uint32_t prescaler;
+    uint32_t period;            /* PWM frequency = TIMCLK / (PSC + 1) / (2 * ARR) */
+    uint32_t repetition;        /* Updates every (RCR + 1) half periods */
+    uint32_t channels;          /* Bit mask, bit 0 = CH1/CH1N */
+    uint32_t deadtime_ns;
+    TIM_BREAK break_input;
+    uint8_t auto_restart;       /* AOE: re-enable outputs at next update after break */
+    uint8_t commutation;        /* CCPC: CCxE/CCxNE/OCxM take effect on COM event */
+    TIM_COM_SOURCE com_source;
+} TIM_COMP_PWM_CONFIG;
+
+/* One channel of a timer, any number can share the same time base */
+typedef struct {
+    TIM_CHANNEL channel;
+    TIM_MODE mode;              /* PWM, OUTPUT_COMPARE or INPUT_CAPTURE */
+    TIM_OC_MODE oc_mode;        /* Output compare only, PWM always uses PWM1 */
+    uint32_t pulse;
+    uint32_t polarity;          /* 0 active high, 1 active low */
+    uint8_t idle_high;          /* OISx on TIM1/TIM8 */
+    TIM_IC_EDGE edge;           /* Input capture only */
+    uint32_t filter;            /* Input capture only, ICxF 0 .. 15 */
+} TIM_CHANNEL_CONFIG;
+
+/* Delayed pulse started by a hardware edge, re-armed after each pulse */
+typedef struct {
+    TIM_TypeDef *ptr_tim;
+    TIM_CHANNEL channel;        /* Output, must not be the trigger input channel */
+    TIM_OPM_TRIGGER trigger;
+    TIM_IC_EDGE edge;           /* Rising or falling */
+    uint32_t filter;            /* ICxF or ETF, 0 .. 15 */
+    uint32_t delay_ns;          /* Trigger edge to pulse start */
+    uint32_t width_ns;
+    uint32_t polarity;          /* 0 active high, 1 active low */
+} TIM_ONE_PULSE_CONFIG;
+
+typedef struct {
+    TIM_TypeDef *ptr_tim;
+    TIM_CHANNEL channel;
+    TIM_IC_EDGE edge;
+    uint32_t prescaler;         /* Counter prescaler, sets capture resolution */
+    uint32_t filter;            /* ICxF, 0 .. 15 */
+    uint32_t divider;           /* ICxPSC, capture every 1, 2, 4 or 8 edges (0 .. 3) */
+    uint32_t *ptr_buffer;       /* Ring buffer filled by DMA */
+    uint16_t length;
+} TIM_CAPTURE_CONFIG;
+
+typedef struct {
+    TIM_TypeDef *ptr_tim;
+    DMA_Stream_TypeDef *ptr_stream;
+    uint32_t *ptr_buffer;
+    uint16_t length;
+    uint16_t tail;
+    uint32_t mask;              /* Counter wrap mask, ARR */
+    uint32_t half_periods;      /* Signal half periods between two captures */
+} TIM_CAPTURE;
+
+typedef struct {
+    TIM_TypeDef *ptr_tim;
+    uint32_t filter;            /* IC1F/IC2F, 0 .. 15 */
+    uint8_t invert;             /* Reverse counting direction */
+    uint32_t sample_hz;         /* Rate of timerEncoderSample() calls */
+    uint8_t irq_priority;       /* Must preempt every caller of timerEncoderGetCount() */
+} TIM_ENCODER_CONFIG;
+
+typedef struct {
+    TIM_TypeDef *ptr_tim;
+    volatile int64_t base;      /* Counts accumulated by counter wraps */
+    uint64_t range;             /* ARR + 1 */
+    int64_t last_count;
+    int32_t velocity;           /* Counts per second from the last sample */
+    uint32_t sample_hz;
+} TIM_ENCODER;
+
+/* One sequencer step, laid out as the DMA burst ARR, RCR, CCR1 .. CCR4 */
+typedef struct {
+    uint32_t period;            /* ARR */
+    uint32_t repeat;            /* RCR, the step lasts repeat + 1 periods, 0 .. 255 */
+    uint32_t duty[4];           /* CCR1 .. CCR4 */
+} TIM_SEQ_STEP;
+
+typedef struct {
+    TIM_TypeDef *ptr_tim;
+    DMA_Stream_TypeDef *ptr_stream;
+    volatile uint8_t state;
+    fp_tim_callback callback;
+    void *ptr_ctx;
+} TIM_SEQUENCER;
+
+/* PWM audio, samples are written to CCRx by the update DMA */
+typedef struct {
+    TIM_TypeDef *ptr_tim;       /* TIM1, TIM3, TIM4 or TIM8 */
+    TIM_CHANNEL channel;
+    uint32_t sample_rate_hz;    /* Also the PWM carrier frequency */
+    uint32_t min_bits;          /* Required resolution, 8 .. 12 */
+    uint16_t *ptr_buffer;       /* Circular buffer, refilled half by half */
+    uint16_t length;            /* Samples, even */
+    fp_tim_callback half_callback;
+    fp_tim_callback full_callback;
+    void *ptr_ctx;
+    uint8_t irq_priority;
+} TIM_AUDIO_CONFIG;
+
+typedef struct {
+    TIM_TypeDef *ptr_tim;
+    DMA_Stream_TypeDef *ptr_stream;
+    uint32_t full_scale;        /* ARR + 1, sample values are 0 .. full_scale - 1 */
+    uint32_t bits;              /* Effective resolution */
+} TIM_AUDIO;
+
+/* DMA burst frame: [ARR, RCR,] CCR1 .. CCRn, ARR/RCR on TIM1/TIM8 only */
+typedef struct {
+    TIM_TypeDef        *ptr_tim;
+    DMA_Stream_TypeDef *ptr_stream;
+    uint32_t           length;
+    uint32_t           frame[TIM_BURST_MAX_WORDS];
+} TIM_BURST;
+
 /**
  * @section Public Function Declarations.
+ * @note    Ownership is checked where a timer is claimed or released:
+ *          timerInit()/Start()/Stop(), timerAcquire()/Release()/Deinit(), the
+ *          handle calls and every service *Init(). Calls that take a raw
+ *          TIM_TypeDef pointer or a service object (master/slave, sync,
+ *          cascade, channel, callback/IRQ, outputs, commutation, burst and
+ *          the service start/stop calls) act on a timer the caller already
+ *          owns and do not check it again.
  */
-void timerInit(const TIM_CONFIG *ptr_cfg);
-void timerStart(const TIM_CONFIG *ptr_cfg);
-void timerStop(const TIM_CONFIG *ptr_cfg);
+int timerInit(const TIM_CONFIG *ptr_cfg);
+int timerStart(const TIM_CONFIG *ptr_cfg);
+int timerStop(const TIM_CONFIG *ptr_cfg);
+TIM_ID timerGetId(const TIM_TypeDef *ptr_tim);
+TIM_HANDLE *timerAcquire(TIM_TypeDef *ptr_tim, const void *ptr_owner);
+int timerRelease(TIM_HANDLE *ptr_handle, const void *ptr_owner);
+int timerDeinit(TIM_TypeDef *ptr_tim, const void *ptr_owner);
+int timerHandleInit(TIM_HANDLE *ptr_handle, const TIM_CONFIG *ptr_cfg);
+int timerHandleStart(TIM_HANDLE *ptr_handle);
+int timerHandleStop(TIM_HANDLE *ptr_handle);
+TIM_TypeDef *timerHandleGetInstance(const TIM_HANDLE *ptr_handle);
+uint32_t timerHandleGetClock(const TIM_HANDLE *ptr_handle);
+uint32_t timerHandleGetCaps(const TIM_HANDLE *ptr_handle);
+uint8_t timerHandleGetChannels(const TIM_HANDLE *ptr_handle);
+int timerSetCompare(TIM_HANDLE *ptr_handle, TIM_CHANNEL channel, uint32_t ticks);
+int timerSetDuty(TIM_HANDLE *ptr_handle, TIM_CHANNEL channel, uint32_t permille);
+int timerSetPeriod(TIM_HANDLE *ptr_handle, uint32_t period);
+int timerSetFrequency(TIM_HANDLE *ptr_handle, uint32_t hz);
+int timerRetuneFrequency(TIM_HANDLE *ptr_handle, uint32_t hz);
+void timerRegisterCallback(TIM_TypeDef *ptr_tim, TIM_EVENT event, fp_tim_callback ptr_callback, void *ptr_ctx);
+void timerEnableIrq(TIM_TypeDef *ptr_tim, uint8_t priority);
 void timerHandleIrq(TIM_TypeDef *ptr_tim);
+void timerHandleIrqFlags(TIM_TypeDef *ptr_tim, uint32_t flags);
+int timerSetMaster(TIM_TypeDef *ptr_tim, TIM_TRGO trgo);
+int timerSetSlave(TIM_TypeDef *ptr_slave, const TIM_TypeDef *ptr_master, TIM_SLAVE_MODE mode);
+int timerSyncStart(TIM_TypeDef *ptr_master, TIM_TypeDef *const *ptr_slaves, uint32_t count);
+int timerCascadeInit(TIM_TypeDef *ptr_low, TIM_TypeDef *ptr_high);
+uint32_t timerCascadeRead(const TIM_TypeDef *ptr_low, const TIM_TypeDef *ptr_high);
+int timerOnePulseInit(const TIM_ONE_PULSE_CONFIG *ptr_cfg);
+void timerOnePulseFire(TIM_TypeDef *ptr_tim);
+int timerConfigChannel(TIM_TypeDef *ptr_tim, const TIM_CHANNEL_CONFIG *ptr_ch);
+int timerConfigChannels(TIM_TypeDef *ptr_tim, const TIM_CHANNEL_CONFIG *ptr_table, uint32_t count);
+uint32_t timerGetClock(const TIM_TypeDef *ptr_tim);
+int timerSolvePeriod(uint32_t clock_hz, uint32_t max_arr, uint32_t hz, uint32_t min_resolution,
+                     uint32_t *ptr_psc, uint32_t *ptr_arr);
+int timerConfigureFrequency(TIM_CONFIG *ptr_cfg, uint32_t hz, uint32_t min_resolution);
+uint64_t timerGetUpdateRate(const TIM_TypeDef *ptr_tim);
+int timerSampleClockInit(TIM_TypeDef *ptr_tim, uint32_t rate_hz, TIM_TRGO trgo, uint64_t *ptr_actual_mhz);
+void timerSampleClockStart(TIM_TypeDef *ptr_tim);
+void timerSampleClockStop(TIM_TypeDef *ptr_tim);
+int timerCaptureInit(TIM_CAPTURE *ptr_cap, const TIM_CAPTURE_CONFIG *ptr_cfg);
+uint32_t timerCaptureRead(TIM_CAPTURE *ptr_cap, uint32_t *ptr_out, uint32_t max);
+int timerCaptureGetFrequency(const TIM_CAPTURE *ptr_cap, uint32_t intervals, uint32_t *ptr_mhz);
+void timerCaptureStop(TIM_CAPTURE *ptr_cap);
+int timerPwmInputInit(TIM_TypeDef *ptr_tim, uint32_t prescaler, uint32_t filter);
+int timerPwmInputGet(TIM_TypeDef *ptr_tim, uint32_t *ptr_mhz, uint32_t *ptr_duty_permille);
+int timerEncoderInit(TIM_ENCODER *ptr_enc, const TIM_ENCODER_CONFIG *ptr_cfg);
+int64_t timerEncoderGetCount(const TIM_ENCODER *ptr_enc);
+int32_t timerEncoderSample(TIM_ENCODER *ptr_enc);
+int32_t timerEncoderGetVelocity(const TIM_ENCODER *ptr_enc);
+int timerEncoderGetEdgeVelocity(const TIM_ENCODER *ptr_enc, const TIM_CAPTURE *ptr_cap,
+                                uint32_t counts_per_capture, int32_t *ptr_velocity);
+int timerCompPwmInit(const TIM_COMP_PWM_CONFIG *ptr_cfg);
+void timerOutputsEnable(TIM_TypeDef *ptr_tim);
+void timerOutputsDisable(TIM_TypeDef *ptr_tim);
+void timerCommutationStage(TIM_TypeDef *ptr_tim, uint32_t ccer, uint32_t ccmr1, uint32_t ccmr2);
+void timerCommutate(TIM_TypeDef *ptr_tim);
+int timerTimestampInit(TIM_TypeDef *ptr_tim, uint32_t resolution_hz, uint8_t irq_priority);
+uint64_t timerTimestampGet(void);
+uint32_t timerTimestampGetHz(void);
+int timerSeqInit(TIM_SEQUENCER *ptr_seq, TIM_TypeDef *ptr_tim, uint32_t prescaler,
+                 uint32_t channels, uint8_t irq_priority);
+int timerSeqPlay(TIM_SEQUENCER *ptr_seq, const TIM_SEQ_STEP *ptr_steps, uint32_t count,
+                 fp_tim_callback ptr_callback, void *ptr_ctx);
+uint8_t timerSeqIsBusy(const TIM_SEQUENCER *ptr_seq);
+void timerSeqAbort(TIM_SEQUENCER *ptr_seq);
+int timerAudioInit(TIM_AUDIO *ptr_audio, const TIM_AUDIO_CONFIG *ptr_cfg);
+void timerAudioStart(TIM_AUDIO *ptr_audio);
+void timerAudioStop(TIM_AUDIO *ptr_audio);
+void timerAudioDeinit(TIM_AUDIO *ptr_audio);
+uint16_t timerAudioFromPcm16(const TIM_AUDIO *ptr_audio, int16_t sample);
+int timerBurstInit(TIM_BURST *ptr_burst, TIM_TypeDef *ptr_tim, uint32_t channels, uint8_t with_arr);
+int timerBurstCommit(TIM_BURST *ptr_burst, const uint32_t *ptr_values);
+void timerBurstStop(TIM_BURST *ptr_burst);
 
 #endif
@@ -0,0 +1,106 @@
+/**
+ * @file    timer_solve.c
+ * @author  Pratik Dhulubulu
+ * @brief   This file implements the PSC/ARR solver shared by the timer
+ *          frequency helpers. It touches no registers, so the host tests
+ *          build it on its own.
+ */
+
+#include "timer_driver.h"
+
+/**
+ * @section Private Macro Definations.
+ */
+#define TIM_PSC_RANGE       0x10000u
+
+/**
+ * @section Public Function Definations.
+ */
+
+/**
+ * @brief   This function finds the PSC/ARR pair closest to a frequency.
+ * @details Pure function, no register access. Among all prescalers that keep
+ *          at least min_resolution counts per period, the pair with the
+ *          smallest frequency error wins, ties go to the smaller prescaler
+ *          (finer duty resolution). The scan starts at the smallest prescaler
+ *          that fits ARR and ends when
+ *          - the error reaches the floor of any integer tick count, or
+ *          - the count drops below the prescaler: the mirrored pair (count as
+ *            prescaler, prescaler as count) was already scored, and every
+ *            larger prescaler mirrors a smaller one too.
+ *          That bounds the loop to about sqrt(clock_hz / hz) steps.
+ * @param   clock_hz Timer kernel clock.
+ * @param   max_arr Largest ARR value, 0xFFFF or 0xFFFFFFFF.
+ * @param   hz Wanted update frequency.
+ * @param   min_resolution Minimum number of counts per period, at least 2
+ *          since ARR = 0 stops the counter.
+ * @param   ptr_psc Resulting PSC.
+ * @param   ptr_arr Resulting ARR.
+ * @return  TIM_OK on success, TIM_ERR_CFG if no pair meets the constraints.
+ */
+int timerSolvePeriod(uint32_t clock_hz, uint32_t max_arr, uint32_t hz, uint32_t min_resolution,
+                     uint32_t *ptr_psc, uint32_t *ptr_arr)
+{
+    if ((hz == 0u) || (clock_hz < hz) || (ptr_psc == NULL) || (ptr_arr == NULL))
+    {
+        return TIM_ERR_CFG;
+    }
+
+    uint64_t range = (uint64_t)max_arr + 1u;
+    uint64_t res = (min_resolution < 2u) ? 2u : min_resolution;
+    uint64_t best_err = UINT64_MAX;
+
+    /* No pair can beat the nearest whole tick count */
+    uint32_t rem = clock_hz % hz;
+    uint64_t err_floor = (rem < (hz - rem)) ? rem : (hz - rem);
+
+    /* Smallest divider that keeps ARR in range for the ideal tick count */
+    uint64_t ticks = ((uint64_t)clock_hz + (hz / 2u)) / hz;
+    uint64_t div = (ticks + range - 1u) / range;
+
+    if (ticks < res)
+    {
+        return TIM_ERR_CFG;
+    }
+    if (div == 0u)
+    {
+        div = 1u;
+    }
+
+    for (; div <= TIM_PSC_RANGE; div++)
+    {
+        uint64_t step = (uint64_t)hz * div;
+        uint64_t count = ((uint64_t)clock_hz + (step / 2u)) / step;
+
+        if (count < res)
+        {
+            count = res;
+        }
+        else if (count > range)
+        {
+            count = range;
+        }
+
+        uint64_t actual = step * count;
+        uint64_t err = (actual > clock_hz) ? (actual - clock_hz) : (clock_hz - actual);
+
+        if (err < best_err)
+        {
+            best_err = err;
+            *ptr_psc = (uint32_t)(div - 1u);
+            *ptr_arr = (uint32_t)(count - 1u);
+
+            if (err <= err_floor)
+            {
+                break;
+            }
+        }
+
+        if (count < div)
+        {
+            break;
+        }
+    }
+
+    return (best_err == UINT64_MAX) ? TIM_ERR_CFG : TIM_OK;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file    test_soft_timer.c
+ * @author  Pratik Dhulubulu
+ * @brief   Host test for the software timer wheel.
+ * @details The wheel is clocked by a simulated tick and SOFT_TIMER_IRQn runs
+ *          whenever it is pended. Every callback records the wheel tick it
+ *          ran on, so expiries on and around the cascade boundaries of each
+ *          level are checked to the exact tick, also when the interrupt is
+ *          held off for several ticks as after a tickless idle.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../Drivers/SoftTimer_Driver/soft_timer_driver.c"
+
+/**
+ * @section Private Macro Definations.
+ */
+#define TEST_MAX_FIRES    32U
+#define TEST_PERIODS      20U
+
+/**
+ * @section Private Type Definations.
+ */
+typedef struct {
+    uint32_t fires;
+    uint32_t at[TEST_MAX_FIRES];
+} TEST_RECORD;
+
+/**
+ * @section Private Data Definations.
+ */
+static uint32_t sim_tick;
+static int sim_pending;
+static uint32_t test_failures;
+
+static const uint32_t test_delays[] = {
+    1u, 2u, 63u, 64u, 65u, 127u, 128u, 129u,
+    4095u, 4096u, 4097u, 8192u, 262143u, 262144u, 262145u, 524288u,
+    WHEEL_SPAN - 1u, WHEEL_SPAN, WHEEL_SPAN + 64u
+};
+
+static const uint32_t test_bases[] = {
+    0u, 1u, 37u, 63u, 64u, 4095u, 262143u, 0xFFFFFFC0u, 0xFFFFFFFFu
+};
+
+/**
+ * @section Private Function Definations.
+ */
+static void testCheck(int cond, const char *what, uint32_t base, uint32_t arg)
+{
+    if (!cond)
+    {
+        test_failures++;
+        printf("FAIL %s base=0x%x arg=%u\n", what, base, arg);
+    }
+}
+
+static void testRecord(void *ptr_ctx)
+{
+    TEST_RECORD *ptr_rec = (TEST_RECORD *)ptr_ctx;
+
+    if (ptr_rec->fires < TEST_MAX_FIRES)
+    {
+        ptr_rec->at[ptr_rec->fires] = wheel_now;
+    }
+    ptr_rec->fires++;
+}
+
+/* Advance the tick by step, then let the pended interrupt catch up */
+static void simAdvance(uint32_t step)
+{
+    for (uint32_t i = 0u; i < step; i++)
+    {
+        sim_tick++;
+        softTimerHandleTick();
+    }
+
+    if (sim_pending != 0)
+    {
+        sim_pending = 0;
+        softTimerHandleIrq();
+    }
+}
+
+static void simReset(uint32_t base)
+{
+    sim_tick = base;
+    sim_pending = 0;
+    softTimerInit(15u);
+}
+
+uint32_t sysTickGetTick(void)
+{
+    return sim_tick;
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return 0u;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    (void)primask;
+}
+
+void __disable_irq(void)
+{
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+    (void)irq;
+    (void)priority;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+    (void)irq;
+    sim_pending = 0;
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq)
+{
+    (void)irq;
+    sim_pending = 1;
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    (void)irq;
+}
+
+/**
+ * @brief One-shot timers expiring on and next to every cascade boundary.
+ */
+static void testOneShot(uint32_t step)
+{
+    for (size_t b = 0u; b < (sizeof(test_bases) / sizeof(test_bases[0])); b++)
+    {
+        for (size_t d = 0u; d < (sizeof(test_delays) / sizeof(test_delays[0])); d++)
+        {
+            uint32_t base = test_bases[b];
+            uint32_t delay = test_delays[d];
+            TEST_RECORD rec = { 0u, { 0u } };
+            SOFT_TIMER timer;
+
+            simReset(base);
+            softTimerSetup(&timer, testRecord, &rec);
+            testCheck(softTimerStart(&timer, delay, 0u) == SOFT_TIMER_OK, "start", base, delay);
+
+            while (((sim_tick - base) < (delay + step)) && (rec.fires == 0u))
+            {
+                simAdvance(step);
+            }
+
+            testCheck(rec.fires == 1u, "one-shot count", base, delay);
+            testCheck(rec.at[0] == (base + delay), "one-shot tick", base, delay);
+            testCheck(softTimerIsActive(&timer) == 0u, "one-shot idle", base, delay);
+        }
+    }
+}
+
+/**
+ * @brief Periodic timers whose period is a multiple of a level span.
+ */
+static void testPeriodic(void)
+{
+    static const uint32_t periods[] = { 1u, 63u, 64u, 65u, 4096u, 262144u };
+
+    for (size_t b = 0u; b < (sizeof(test_bases) / sizeof(test_bases[0])); b++)
+    {
+        for (size_t p = 0u; p < (sizeof(periods) / sizeof(periods[0])); p++)
+        {
+            uint32_t base = test_bases[b];
+            uint32_t period = periods[p];
+            TEST_RECORD rec = { 0u, { 0u } };
+            SOFT_TIMER timer;
+
+            simReset(base);
+            softTimerSetup(&timer, testRecord, &rec);
+            (void)softTimerStart(&timer, period, period);
+
+            while (rec.fires < TEST_PERIODS)
+            {
+                simAdvance(1u);
+            }
+
+            softTimerCancel(&timer);
+
+            for (uint32_t i = 0u; i < TEST_PERIODS; i++)
+            {
+                testCheck(rec.at[i] == (base + ((i + 1u) * period)), "periodic tick", base, period);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Delays above the wheel range are rejected.
+ */
+static void testRejects(void)
+{
+    SOFT_TIMER timer;
+    TEST_RECORD rec = { 0u, { 0u } };
+
+    simReset(0u);
+    softTimerSetup(&timer, testRecord, &rec);
+    testCheck(softTimerStart(&timer, SOFT_TIMER_MAX_TICKS + 1u, 0u) == SOFT_TIMER_ERR_CFG,
+              "delay limit", 0u, SOFT_TIMER_MAX_TICKS + 1u);
+    testCheck(softTimerStart(&timer, 1u, SOFT_TIMER_MAX_TICKS + 1u) == SOFT_TIMER_ERR_CFG,
+              "period limit", 0u, SOFT_TIMER_MAX_TICKS + 1u);
+}
+
+int main(void)
+{
+    testOneShot(1u);
+    testOneShot(7u);
+    testPeriodic();
+    testRejects();
+
+    if (test_failures != 0u)
+    {
+        printf("test_soft_timer: %u failure(s)\n", test_failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("test_soft_timer: PASS\n");
+    return EXIT_SUCCESS;
+}
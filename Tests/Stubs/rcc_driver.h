@@ -0,0 +1,29 @@
+/**
+ * @file    rcc_driver.h
+ * @author  Pratik Dhulubulu
+ * @brief   Host stand-in for the RCC driver interface used by the driver tests.
+ */
+
+#ifndef RCC_DRIVER_H
+#define RCC_DRIVER_H
+
+#include <stdint.h>
+#include "stm32f446xx.h"
+
+/**
+ * @section Public Macro Definations.
+ */
+#define RCC_OK        0
+
+/**
+ * @section Public Type Definations.
+ */
+typedef void (*fp_rcc_clock_callback)(void);
+
+/**
+ * @section Public Function Declarations.
+ */
+uint32_t rccGetHCLK(void);
+int rccRegisterClockCallback(fp_rcc_clock_callback ptr_callback);
+
+#endif
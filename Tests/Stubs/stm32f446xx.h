@@ -0,0 +1,99 @@
+/**
+ * @file    stm32f446xx.h
+ * @author  Pratik Dhulubulu
+ * @brief   Host stand-in for the device header used by the driver tests.
+ * @details Every register block is reached through a hook function, so a
+ *          test can advance the simulated hardware or inject an interrupt
+ *          between any two register accesses of the code under test.
+ */
+
+#ifndef STM32F446XX_H
+#define STM32F446XX_H
+
+#include <stdint.h>
+
+/**
+ * @section Public Macro Definations.
+ */
+#define __IM     volatile const
+#define __IOM    volatile
+
+#define SysTick_CTRL_ENABLE_Msk      (1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk     (1UL << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk   (1UL << 2)
+#define SysTick_CTRL_COUNTFLAG_Msk   (1UL << 16)
+#define SysTick_LOAD_RELOAD_Msk      (0xFFFFFFUL)
+#define SCB_ICSR_PENDSTSET_Msk       (1UL << 26)
+#define DWT_CTRL_CYCCNTENA_Msk       (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk   (1UL << 24)
+
+#define SysTick   (testSysTick())
+#define SCB       (testScb())
+#define DWT       (testDwt())
+#define CoreDebug (testCoreDebug())
+
+#define __DMB()   testBarrier()
+#define __DSB()   testBarrier()
+#define __ISB()   testBarrier()
+#define __NOP()   ((void)0)
+#define __WFI()   testWfi()
+
+/**
+ * @section Public Type Definations.
+ */
+typedef enum
+{
+    SysTick_IRQn = -1
+} IRQn_Type;
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t LOAD;
+    __IOM uint32_t VAL;
+    __IM  uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+    __IOM uint32_t ICSR;
+} SCB_Type;
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    __IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+/* Only used through pointers by the driver headers */
+typedef struct TIM_TypeDef TIM_TypeDef;
+typedef struct DMA_Stream_TypeDef DMA_Stream_TypeDef;
+
+/**
+ * @section Public Data Declarations.
+ */
+extern uint32_t SystemCoreClock;
+
+/**
+ * @section Public Function Declarations.
+ */
+SysTick_Type *testSysTick(void);
+SCB_Type *testScb(void);
+DWT_Type *testDwt(void);
+CoreDebug_Type *testCoreDebug(void);
+void testBarrier(void);
+void testWfi(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq(void);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_EnableIRQ(IRQn_Type irq);
+
+#endif
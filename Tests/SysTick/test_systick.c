@@ -0,0 +1,443 @@
+/**
+ * @file    test_systick.c
+ * @author  Pratik Dhulubulu
+ * @brief   Host test for the SysTick 64-bit time base.
+ * @details The driver is compiled against a simulated SysTick. The simulated
+ *          counter advances on every register access and the SysTick ISR is
+ *          injected at a chosen access, so every interleaving of reader and
+ *          ISR is exercised, including the 32-bit tick wrap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../Drivers/SysTick_Driver/systick_driver.c"
+
+/**
+ * @section Private Macro Definations.
+ */
+#define TEST_CLK_HZ       1000000UL
+#define TEST_LOAD         999UL
+#define TEST_MAX_INJECT   32U
+#define TEST_STEP_DIV     4U
+
+/**
+ * @section Public Data Definations.
+ */
+uint32_t SystemCoreClock = TEST_CLK_HZ;
+
+/**
+ * @section Private Data Definations.
+ */
+static SysTick_Type sim_systick;
+static SCB_Type sim_scb;
+static DWT_Type sim_dwt;
+static CoreDebug_Type sim_core_debug;
+static uint32_t sim_val_seen;
+static uint64_t sim_cycles;
+static uint32_t sim_wake_after;
+static uint32_t sim_hclk = TEST_CLK_HZ;
+static uint32_t sim_step;
+static uint32_t sim_frac;
+static uint32_t sim_access;
+static uint32_t sim_inject_at;
+static int sim_in_isr;
+static int sim_in_nested;
+static int sim_nested_check;
+static uint64_t sim_nested_old;
+static uint64_t sim_nested_new;
+static uint32_t sim_nested_reads;
+static uint32_t test_failures;
+
+static const uint64_t test_bases[] =
+{
+    0x000000000ULL, 0x0FFFFFFFEULL, 0x0FFFFFFFFULL, 0x1FFFFFFFFULL
+};
+
+/**
+ * @section Private Function Definations.
+ */
+static void testCheck(int cond, const char *what, uint64_t base, uint32_t arg)
+{
+    if (!cond)
+    {
+        test_failures++;
+        printf("FAIL %s base=0x%llx arg=%u\n", what, (unsigned long long)base, arg);
+    }
+}
+
+static void simSetTick(uint64_t value)
+{
+    tick_seq = 0u;
+    tick_slot[0] = value;
+    tick_slot[1] = value;
+    tick = (uint32_t)value;
+}
+
+static void simIsr(void)
+{
+    sim_in_isr = 1;
+    sim_scb.ICSR &= ~SCB_ICSR_PENDSTSET_Msk;
+    sysTickHandleIrq();
+    sim_in_isr = 0;
+}
+
+static void simCount(void)
+{
+    if ((sim_systick.CTRL & SysTick_CTRL_ENABLE_Msk) != 0u)
+    {
+        if (sim_systick.VAL == 0u)
+        {
+            /* LOAD is latched on the reload only */
+            sim_systick.VAL = sim_systick.LOAD;
+        }
+        else if (--sim_systick.VAL == 0u)
+        {
+            sim_systick.CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+            sim_scb.ICSR |= SCB_ICSR_PENDSTSET_Msk;
+        }
+    }
+    sim_cycles++;
+    sim_dwt.CYCCNT = (uint32_t)sim_cycles;
+    sim_val_seen = sim_systick.VAL;
+}
+
+static void simClock(void)
+{
+    if (sim_systick.VAL != sim_val_seen)
+    {
+        /* Any write to VAL clears the counter and COUNTFLAG */
+        sim_systick.VAL = 0u;
+        sim_systick.CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+        sim_val_seen = 0u;
+    }
+
+    /* sim_step is in 1/TEST_STEP_DIV counter clocks per register access */
+    for (sim_frac += sim_step; sim_frac >= TEST_STEP_DIV; sim_frac -= TEST_STEP_DIV)
+    {
+        simCount();
+    }
+}
+
+static void simStart(uint64_t base, uint32_t val, uint32_t step)
+{
+    simSetTick(base);
+    sim_systick.CTRL = SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_CLKSOURCE_Msk;
+    sim_systick.LOAD = TEST_LOAD;
+    sim_systick.VAL = val;
+    sim_val_seen = val;
+    /* VAL at zero means the 1 to 0 step just pended the ISR */
+    sim_scb.ICSR = (val == 0u) ? SCB_ICSR_PENDSTSET_Msk : 0u;
+    sim_cycles = (base * (TEST_LOAD + 1u)) + (TEST_LOAD - val);
+    sim_dwt.CYCCNT = (uint32_t)sim_cycles;
+    sim_step = step;
+    sim_frac = 0u;
+    sim_access = 0u;
+}
+
+static void simAccess(void)
+{
+    if (sim_in_isr != 0)
+    {
+        return;
+    }
+    simClock();
+    if (++sim_access == sim_inject_at)
+    {
+        if (sim_step == 0u)
+        {
+            /* Frozen counter, force a tick at this point */
+            simIsr();
+        }
+        else if ((sim_scb.ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u)
+        {
+            simIsr();
+        }
+    }
+}
+
+SysTick_Type *testSysTick(void)
+{
+    simAccess();
+    return &sim_systick;
+}
+
+SCB_Type *testScb(void)
+{
+    simAccess();
+    return &sim_scb;
+}
+
+DWT_Type *testDwt(void)
+{
+    simAccess();
+    return &sim_dwt;
+}
+
+CoreDebug_Type *testCoreDebug(void)
+{
+    simAccess();
+    return &sim_core_debug;
+}
+
+void testBarrier(void)
+{
+    if ((sim_in_isr != 0) && (sim_nested_check != 0) && (sim_in_nested == 0))
+    {
+        /* A higher priority reader preempts the tick update */
+        sim_in_nested = 1;
+        uint64_t value = sysTickGetTick64();
+        sim_in_nested = 0;
+
+        sim_nested_reads++;
+        testCheck((value == sim_nested_old) || (value == sim_nested_new),
+                  "nested read saw a torn tick", sim_nested_old, sim_nested_reads);
+        return;
+    }
+    simAccess();
+}
+
+void testWfi(void)
+{
+    /* Sleep until the tick pends or another interrupt wakes the core */
+    for (uint32_t i = 0u; i < sim_wake_after; i++)
+    {
+        if ((sim_scb.ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u)
+        {
+            break;
+        }
+        simCount();
+    }
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return 0u;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    (void)primask;
+}
+
+void __disable_irq(void)
+{
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+    (void)irq;
+    (void)priority;
+}
+
+uint32_t rccGetHCLK(void)
+{
+    return sim_hclk;
+}
+
+int rccRegisterClockCallback(fp_rcc_clock_callback ptr_callback)
+{
+    (void)ptr_callback;
+    return RCC_OK;
+}
+
+/**
+ * @brief ISR injected at every point of a 64-bit tick read.
+ */
+static void testTick64Preempted(void)
+{
+    sim_step = 0u;
+
+    for (size_t b = 0u; b < (sizeof(test_bases) / sizeof(test_bases[0])); b++)
+    {
+        for (uint32_t k = 1u; k <= TEST_MAX_INJECT; k++)
+        {
+            simSetTick(test_bases[b]);
+            sim_access = 0u;
+            sim_inject_at = k;
+
+            uint64_t value = sysTickGetTick64();
+            uint64_t after = (sim_access >= k) ? (test_bases[b] + 1u) : test_bases[b];
+            sim_inject_at = 0u;
+
+            testCheck((value == test_bases[b]) || (value == after), "tick64 read", test_bases[b], k);
+            testCheck(sysTickGetTick64() == after, "tick64 count", test_bases[b], k);
+            testCheck(tick == (uint32_t)after, "tick low word", test_bases[b], k);
+        }
+    }
+}
+
+/**
+ * @brief Reader preempting the ISR between its stores.
+ */
+static void testTick64Nested(void)
+{
+    sim_step = 0u;
+    sim_inject_at = 0u;
+    sim_nested_check = 1;
+
+    for (size_t b = 0u; b < (sizeof(test_bases) / sizeof(test_bases[0])); b++)
+    {
+        simSetTick(test_bases[b]);
+        sim_nested_old = test_bases[b];
+        sim_nested_new = test_bases[b] + 1u;
+        sim_nested_reads = 0u;
+
+        simIsr();
+
+        testCheck(sim_nested_reads != 0u, "nested read not exercised", test_bases[b], 0u);
+        testCheck(sysTickGetTick64() == sim_nested_new, "nested final count", test_bases[b], 0u);
+    }
+
+    sim_nested_check = 0;
+}
+
+/**
+ * @brief Microsecond time against the simulated cycle count.
+ */
+static void testUs64Bounds(void)
+{
+    static const uint32_t start_vals[] =
+    {
+        TEST_LOAD, 500u, 16u, 15u, 14u, 13u, 12u, 11u, 10u, 9u, 8u, 7u, 6u, 5u, 4u, 3u, 2u, 1u, 0u
+    };
+    static const uint32_t steps[] = { 1u, 2u, 4u, 8u, 20u };
+
+    systick_clk_hz = TEST_CLK_HZ;
+    systick_cycles_per_tick = TEST_LOAD + 1u;
+
+    for (size_t b = 0u; b < (sizeof(test_bases) / sizeof(test_bases[0])); b++)
+    {
+        for (size_t v = 0u; v < (sizeof(start_vals) / sizeof(start_vals[0])); v++)
+        {
+            for (size_t s = 0u; s < (sizeof(steps) / sizeof(steps[0])); s++)
+            {
+                for (uint32_t k = 0u; k <= TEST_MAX_INJECT; k++)
+                {
+                    simStart(test_bases[b], start_vals[v], steps[s]);
+                    sim_inject_at = k;
+
+                    uint64_t before = sim_cycles;
+                    uint64_t us = sysTickGetUs64();
+                    uint64_t after = sim_cycles;
+
+                    testCheck((us >= before) && (us <= after), "us64 outside read window",
+                              test_bases[b], (start_vals[v] << 16) | (steps[s] << 8) | k);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Tickless idle keeps the tick grid of the periodic counter.
+ */
+static void testIdleGrid(void)
+{
+    static const uint32_t start_vals[] = { TEST_LOAD, 500u, 20u, 3u, 1u };
+    static const uint32_t idle_ticks[] = { 2u, 3u, 17u };
+    static const uint32_t wakes[] =
+    {
+        0u, 1u, 5u, 15u, 16u, 17u, 400u, 999u, 1000u, 1001u, 1990u, 2500u, 16990u, 100000u
+    };
+    static const uint32_t steps[] = { 4u, 12u };
+
+    systick_clk_hz = TEST_CLK_HZ;
+    systick_cycles_per_tick = TEST_LOAD + 1u;
+    sim_inject_at = 0u;
+
+    for (size_t v = 0u; v < (sizeof(start_vals) / sizeof(start_vals[0])); v++)
+    {
+        for (size_t n = 0u; n < (sizeof(idle_ticks) / sizeof(idle_ticks[0])); n++)
+        {
+            for (size_t w = 0u; w < (sizeof(wakes) / sizeof(wakes[0])); w++)
+            {
+                for (size_t s = 0u; s < (sizeof(steps) / sizeof(steps[0])); s++)
+                {
+                    uint64_t base = test_bases[1];
+                    uint32_t arg = (uint32_t)((v << 24) | (n << 16) | (w << 8) | s);
+
+                    simStart(base, start_vals[v], steps[s]);
+                    sim_wake_after = wakes[w];
+
+                    (void)sysTickIdle(idle_ticks[n]);
+
+                    /* Let the counter run with the ISR taken on every pend */
+                    for (uint32_t i = 0u; i < (3u * (TEST_LOAD + 1u)); i++)
+                    {
+                        if ((sim_scb.ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u)
+                        {
+                            simIsr();
+                        }
+                        simCount();
+                    }
+                    if ((sim_scb.ICSR & SCB_ICSR_PENDSTSET_Msk) != 0u)
+                    {
+                        simIsr();
+                    }
+
+                    /* Only the few accesses around each stop and start go unmeasured */
+                    uint64_t period = TEST_LOAD + 1u;
+                    uint64_t slack = 2u * ((steps[s] + TEST_STEP_DIV - 1u) / TEST_STEP_DIV);
+                    uint64_t ticks = sysTickGetTick64();
+                    uint64_t now = (sim_systick.VAL != 0u) ? ((ticks * period) + (TEST_LOAD - sim_systick.VAL))
+                                                           : ((ticks * period) - 1u);
+
+                    testCheck((now <= sim_cycles) && ((sim_cycles - now) <= slack), "idle tick grid", base, arg);
+                    testCheck(sim_systick.LOAD == TEST_LOAD, "idle period restored", base, arg);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Clock change keeps the position within the current period.
+ */
+static void testClockChange(void)
+{
+    static const uint32_t start_vals[] = { TEST_LOAD, 750u, 500u, 100u };
+
+    sim_inject_at = 0u;
+
+    for (size_t v = 0u; v < (sizeof(start_vals) / sizeof(start_vals[0])); v++)
+    {
+        uint64_t base = test_bases[2];
+
+        sim_hclk = TEST_CLK_HZ;
+        simStart(base, start_vals[v], 4u);
+        systick_clk_hz = TEST_CLK_HZ;
+        systick_cycles_per_tick = TEST_LOAD + 1u;
+        systick_rate_hz = TEST_CLK_HZ / (TEST_LOAD + 1u);
+
+        /* Double the core clock, the same tick rate needs twice the reload */
+        sim_hclk = 2u * TEST_CLK_HZ;
+        sysTickClockChanged();
+
+        uint32_t left = 2u * start_vals[v];
+
+        testCheck(sim_systick.LOAD == ((2u * (TEST_LOAD + 1u)) - 1u), "clock change period", base, start_vals[v]);
+        testCheck((sim_systick.VAL <= left) && (sim_systick.VAL + 64u >= left), "clock change fraction",
+                  base, start_vals[v]);
+        testCheck(sysTickGetTick64() == base, "clock change tick", base, start_vals[v]);
+    }
+
+    sim_hclk = TEST_CLK_HZ;
+}
+
+int main(void)
+{
+    testTick64Preempted();
+    testTick64Nested();
+    testUs64Bounds();
+    testIdleGrid();
+    testClockChange();
+
+    if (test_failures != 0u)
+    {
+        printf("test_systick: %u failure(s)\n", test_failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("test_systick: PASS\n");
+    return EXIT_SUCCESS;
+}
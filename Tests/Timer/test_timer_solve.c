@@ -0,0 +1,163 @@
+/**
+ * @file    test_timer_solve.c
+ * @author  Pratik Dhulubulu
+ * @brief   Host test for the timer PSC/ARR solver.
+ * @details The solver is checked against a brute-force scan of every
+ *          prescaler for both timer kernel clocks of the board profile the
+ *          test is built for, 16-bit and 32-bit counters, several minimum
+ *          resolutions and a dense grid of frequencies.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "clock_profile.h"
+#include "../../Drivers/Timer_Driver/timer_solve.c"
+
+/**
+ * @section Private Macro Definations.
+ */
+#define TEST_GRID_STEP    1.03
+#define TEST_NEIGHBOURS   3U
+
+/**
+ * @section Private Data Definations.
+ */
+static const uint32_t test_clocks[] = { CLK_TIMCLK1_HZ, CLK_TIMCLK2_HZ };
+static const uint32_t test_max_arr[] = { 0xFFFFu, 0xFFFFFFFFu };
+static const uint32_t test_resolutions[] = { 0u, 100u, 1000u };
+static uint32_t test_failures;
+static uint32_t test_points;
+
+/**
+ * @section Private Function Definations.
+ */
+static void testCheck(int cond, const char *what, uint32_t clock_hz, uint32_t max_arr,
+                      uint32_t hz, uint32_t min_resolution)
+{
+    if (!cond)
+    {
+        test_failures++;
+        printf("FAIL %s clock=%u max_arr=0x%x hz=%u res=%u\n", what, clock_hz, max_arr, hz,
+               min_resolution);
+    }
+}
+
+/* Every prescaler with the best count it allows, smallest error wins */
+static int testReference(uint32_t clock_hz, uint32_t max_arr, uint32_t hz, uint32_t min_resolution,
+                         uint64_t *ptr_err, uint32_t *ptr_psc, uint32_t *ptr_arr)
+{
+    uint64_t range = (uint64_t)max_arr + 1u;
+    uint64_t res = (min_resolution < 2u) ? 2u : min_resolution;
+    uint64_t ticks = ((uint64_t)clock_hz + (hz / 2u)) / hz;
+
+    if (ticks < res)
+    {
+        return TIM_ERR_CFG;
+    }
+
+    *ptr_err = UINT64_MAX;
+
+    for (uint64_t div = 1u; div <= 0x10000u; div++)
+    {
+        uint64_t step = (uint64_t)hz * div;
+        uint64_t count = ((uint64_t)clock_hz + (step / 2u)) / step;
+
+        count = (count < res) ? res : ((count > range) ? range : count);
+
+        uint64_t actual = step * count;
+        uint64_t err = (actual > clock_hz) ? (actual - clock_hz) : (clock_hz - actual);
+
+        if (err < *ptr_err)
+        {
+            *ptr_err = err;
+            *ptr_psc = (uint32_t)(div - 1u);
+            *ptr_arr = (uint32_t)(count - 1u);
+        }
+    }
+
+    return TIM_OK;
+}
+
+static void testPoint(uint32_t clock_hz, uint32_t max_arr, uint32_t hz, uint32_t min_resolution)
+{
+    uint32_t psc = 0u;
+    uint32_t arr = 0u;
+    uint32_t ref_psc = 0u;
+    uint32_t ref_arr = 0u;
+    uint64_t ref_err = 0u;
+
+    int ret = timerSolvePeriod(clock_hz, max_arr, hz, min_resolution, &psc, &arr);
+    int ref = testReference(clock_hz, max_arr, hz, min_resolution, &ref_err, &ref_psc, &ref_arr);
+
+    test_points++;
+    testCheck(ret == ref, "status", clock_hz, max_arr, hz, min_resolution);
+
+    if ((ret != TIM_OK) || (ref != TIM_OK))
+    {
+        return;
+    }
+
+    uint64_t actual = (uint64_t)hz * (psc + 1u) * ((uint64_t)arr + 1u);
+    uint64_t err = (actual > clock_hz) ? (actual - clock_hz) : (clock_hz - actual);
+
+    testCheck(psc <= 0xFFFFu, "psc range", clock_hz, max_arr, hz, min_resolution);
+    testCheck(arr <= max_arr, "arr range", clock_hz, max_arr, hz, min_resolution);
+    testCheck(((uint64_t)arr + 1u) >= min_resolution, "resolution", clock_hz, max_arr, hz,
+              min_resolution);
+    testCheck(err == ref_err, "optimal", clock_hz, max_arr, hz, min_resolution);
+    testCheck((psc == ref_psc) && (arr == ref_arr), "tie to smaller psc", clock_hz, max_arr, hz,
+              min_resolution);
+}
+
+static void testSweep(void)
+{
+    for (uint32_t c = 0u; c < (sizeof(test_clocks) / sizeof(test_clocks[0])); c++)
+    {
+        for (uint32_t m = 0u; m < (sizeof(test_max_arr) / sizeof(test_max_arr[0])); m++)
+        {
+            for (uint32_t r = 0u; r < (sizeof(test_resolutions) / sizeof(test_resolutions[0])); r++)
+            {
+                for (double grid = 1.0; grid <= test_clocks[c]; grid *= TEST_GRID_STEP)
+                {
+                    for (uint32_t n = 0u; n < TEST_NEIGHBOURS; n++)
+                    {
+                        testPoint(test_clocks[c], test_max_arr[m], (uint32_t)grid + n,
+                                  test_resolutions[r]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void testRejects(void)
+{
+    uint32_t psc;
+    uint32_t arr;
+    uint32_t clock_hz = CLK_TIMCLK1_HZ;
+
+    testCheck(timerSolvePeriod(clock_hz, 0xFFFFu, 0u, 2u, &psc, &arr) == TIM_ERR_CFG,
+              "zero hz", clock_hz, 0xFFFFu, 0u, 2u);
+    testCheck(timerSolvePeriod(clock_hz, 0xFFFFu, clock_hz + 1u, 2u, &psc, &arr) == TIM_ERR_CFG,
+              "hz above clock", clock_hz, 0xFFFFu, clock_hz + 1u, 2u);
+    testCheck(timerSolvePeriod(clock_hz, 0xFFFFu, clock_hz, 2u, &psc, &arr) == TIM_ERR_CFG,
+              "below resolution", clock_hz, 0xFFFFu, clock_hz, 2u);
+    testCheck(timerSolvePeriod(clock_hz, 0xFFFFu, 1000u, 2u, NULL, &arr) == TIM_ERR_CFG,
+              "null psc", clock_hz, 0xFFFFu, 1000u, 2u);
+}
+
+int main(void)
+{
+    testSweep();
+    testRejects();
+
+    if (test_failures != 0u)
+    {
+        printf("test_timer_solve: %u failure(s) in %u points\n", test_failures, test_points);
+        return EXIT_FAILURE;
+    }
+
+    printf("test_timer_solve (TIMCLK1 %lu Hz, TIMCLK2 %lu Hz): PASS, %u points\n",
+           (unsigned long)CLK_TIMCLK1_HZ, (unsigned long)CLK_TIMCLK2_HZ, test_points);
+    return EXIT_SUCCESS;
+}